@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTDecorator_TargetInRange.h"
+
+#include "Enemy.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTDecorator_TargetInRange::UBTDecorator_TargetInRange() {
+	NodeName = "Target In Range";
+	BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTDecorator_TargetInRange, BlackboardKey), AActor::StaticClass());
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTDecorator_TargetInRange, BlackboardKey));
+	bNotifyBecomeRelevant = true;
+}
+
+void UBTDecorator_TargetInRange::InitializeFromAsset(UBehaviorTree& Asset) {
+	Super::InitializeFromAsset(Asset);
+
+	// Only an abort needs to notice the target leaving the range, the entry check needs no tick
+	bNotifyTick = FlowAbortMode != EBTFlowAbortMode::None;
+}
+
+uint16 UBTDecorator_TargetInRange::GetInstanceMemorySize() const {
+	return sizeof(FBTTargetInRangeMemory);
+}
+
+void UBTDecorator_TargetInRange::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	// Spread the checks so enemies entering the branch together don't test on the same frame
+	FBTTargetInRangeMemory* Memory = CastInstanceNodeMemory<FBTTargetInRangeMemory>(NodeMemory);
+	Memory->TimeUntilCheck = FMath::FRandRange(0.0f, CheckInterval);
+	Memory->bLastResult = CalculateRawConditionValue(OwnerComp, NodeMemory);
+}
+
+void UBTDecorator_TargetInRange::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) {
+	FBTTargetInRangeMemory* Memory = CastInstanceNodeMemory<FBTTargetInRangeMemory>(NodeMemory);
+	Memory->TimeUntilCheck -= DeltaSeconds;
+	if (Memory->TimeUntilCheck > 0.0f) {
+		return;
+	}
+	Memory->TimeUntilCheck = CheckInterval;
+
+	bool bResult = CalculateRawConditionValue(OwnerComp, NodeMemory);
+	if (bResult != Memory->bLastResult) {
+		Memory->bLastResult = bResult;
+		OwnerComp.RequestExecution(this);
+	}
+}
+
+bool UBTDecorator_TargetInRange::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const {
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+
+	FVector TargetLocation;
+	if (!Enemy || !Blackboard || !Blackboard->GetLocationFromEntry(GetSelectedBlackboardKey(), TargetLocation)) {
+		return false;
+	}
+
+	float MaxDistance = Range > 0.0f ? Range : Enemy->WeaponSlot.Range;
+	return FVector::DistSquared(TargetLocation, Enemy->GetActorLocation()) <= FMath::Square(MaxDistance);
+}
+
+FString UBTDecorator_TargetInRange::GetStaticDescription() const {
+	return FString::Printf(TEXT("%s: %s within %s"), *Super::GetStaticDescription(), *GetSelectedBlackboardKey().ToString(),
+		Range > 0.0f ? *FString::SanitizeFloat(Range) : TEXT("weapon range"));
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Decorators/BTDecorator_BlackboardBase.h"
+#include "BTDecorator_TargetInRange.generated.h"
+
+struct FBTTargetInRangeMemory
+{
+	float TimeUntilCheck;
+	bool bLastResult;
+};
+
+/**
+ * Passes when the blackboard target is within Range of the enemy.
+ * The condition is checked when the branch is entered and when the key changes. A target actor moving
+ * doesn't change the key, so a decorator that aborts also checks again every CheckInterval.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UBTDecorator_TargetInRange : public UBTDecorator_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	UBTDecorator_TargetInRange();
+
+	/** Max distance to the target, the weapon range if zero */
+	UPROPERTY(EditAnywhere, Category = "Condition", meta = (ClampMin = "0.0"))
+	float Range = 0.0f;
+
+	/** Seconds between two checks of the aborting decorators */
+	UPROPERTY(EditAnywhere, Category = "Condition", meta = (ClampMin = "0.05"))
+	float CheckInterval = 0.3f;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+};
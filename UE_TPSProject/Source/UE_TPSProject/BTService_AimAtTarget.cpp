@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTService_AimAtTarget.h"
+
+#include "Enemy.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTService_AimAtTarget::UBTService_AimAtTarget() {
+	NodeName = "Aim At Target";
+	Interval = 0.25f;
+	RandomDeviation = 0.05f;
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+	BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_AimAtTarget, BlackboardKey), AActor::StaticClass());
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_AimAtTarget, BlackboardKey));
+}
+
+uint16 UBTService_AimAtTarget::GetInstanceMemorySize() const {
+	return sizeof(FBTAimAtTargetMemory);
+}
+
+void UBTService_AimAtTarget::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	CastInstanceNodeMemory<FBTAimAtTargetMemory>(NodeMemory)->bAimingFromService = false;
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+}
+
+void UBTService_AimAtTarget::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) {
+	FBTAimAtTargetMemory* Memory = CastInstanceNodeMemory<FBTAimAtTargetMemory>(NodeMemory);
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	if (!Enemy) {
+		return;
+	}
+
+	FVector TargetLocation;
+	float Range = AimRange > 0.0f ? AimRange : Enemy->WeaponSlot.Range;
+	bool bInRange = OwnerComp.GetBlackboardComponent()->GetLocationFromEntry(GetSelectedBlackboardKey(), TargetLocation)
+		&& FVector::DistSquared(TargetLocation, Enemy->GetActorLocation()) <= FMath::Square(Range);
+
+	if (bInRange && !Enemy->IsAiming()) {
+		Enemy->AimIn();
+		Memory->bAimingFromService = true;
+	} else if (!bInRange && Memory->bAimingFromService) {
+		Enemy->AimOut();
+		Memory->bAimingFromService = false;
+	}
+}
+
+void UBTService_AimAtTarget::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	FBTAimAtTargetMemory* Memory = CastInstanceNodeMemory<FBTAimAtTargetMemory>(NodeMemory);
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner() ? OwnerComp.GetAIOwner()->GetPawn() : nullptr);
+
+	// Only undo the aim this service started
+	if (Enemy && Memory->bAimingFromService && Enemy->IsAiming()) {
+		Enemy->AimOut();
+	}
+	Memory->bAimingFromService = false;
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
+
+FString UBTService_AimAtTarget::GetStaticDescription() const {
+	return FString::Printf(TEXT("Aim at %s %s"), *GetSelectedBlackboardKey().ToString(), *GetStaticServiceDescription());
+}
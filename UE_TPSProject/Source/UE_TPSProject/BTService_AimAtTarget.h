@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Services/BTService_BlackboardBase.h"
+#include "BTService_AimAtTarget.generated.h"
+
+struct FBTAimAtTargetMemory
+{
+	bool bAimingFromService;
+};
+
+/**
+ * Keeps the enemy aiming while the blackboard target is within AimRange.
+ * Runs at the service interval, not every frame, and only touches the aim when the range test changes.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UBTService_AimAtTarget : public UBTService_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	UBTService_AimAtTarget();
+
+	/** Distance under which the enemy aims, the weapon range if zero */
+	UPROPERTY(EditAnywhere, Category = "Aim", meta = (ClampMin = "0.0"))
+	float AimRange = 0.0f;
+
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTTask_FireWeapon.h"
+
+#include "Enemy.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTTask_FireWeapon::UBTTask_FireWeapon() {
+	NodeName = "Fire Weapon";
+	bNotifyTick = true;
+	bNotifyTaskFinished = true;
+	BlackboardKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FireWeapon, BlackboardKey), AActor::StaticClass());
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FireWeapon, BlackboardKey));
+}
+
+uint16 UBTTask_FireWeapon::GetInstanceMemorySize() const {
+	return sizeof(FBTFireWeaponMemory);
+}
+
+EBTNodeResult::Type UBTTask_FireWeapon::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	// Read by OnTaskFinished, which also runs when the task fails here
+	FBTFireWeaponMemory* Memory = CastInstanceNodeMemory<FBTFireWeaponMemory>(NodeMemory);
+	Memory->bAimedByTask = false;
+
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	if (!Enemy) {
+		return EBTNodeResult::Failed;
+	}
+
+	Memory->Cooldown = 0.0f;
+	Memory->ShotsLeft = BurstCount;
+	Memory->SuppressLeft = SuppressTime;
+
+	if (bAimWhileFiring && !Enemy->IsAiming()) {
+		Enemy->AimIn();
+		Memory->bAimedByTask = true;
+	}
+	return EBTNodeResult::InProgress;
+}
+
+void UBTTask_FireWeapon::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) {
+	FBTFireWeaponMemory* Memory = CastInstanceNodeMemory<FBTFireWeaponMemory>(NodeMemory);
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+
+	FVector TargetLocation;
+	if (!Enemy || !OwnerComp.GetBlackboardComponent()->GetLocationFromEntry(GetSelectedBlackboardKey(), TargetLocation)) {
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	Memory->SuppressLeft -= DeltaSeconds;
+	Memory->Cooldown -= DeltaSeconds;
+	if (Memory->Cooldown > 0.0f) {
+		return;
+	}
+
+	// FireWithSphereSweep shoots along the actor forward vector
+	FVector ToTarget = TargetLocation - Enemy->GetActorLocation();
+	Enemy->SetActorRotation(FRotator(0.0f, ToTarget.Rotation().Yaw, 0.0f));
+	Enemy->FireWithSphereSweep();
+
+	Memory->ShotsLeft--;
+	Memory->Cooldown = Enemy->WeaponSlot.Rate;
+
+	if (Memory->ShotsLeft <= 0 && Memory->SuppressLeft <= 0.0f) {
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+void UBTTask_FireWeapon::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) {
+	FBTFireWeaponMemory* Memory = CastInstanceNodeMemory<FBTFireWeaponMemory>(NodeMemory);
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner() ? OwnerComp.GetAIOwner()->GetPawn() : nullptr);
+	if (Memory->bAimedByTask && Enemy && Enemy->IsAiming()) {
+		Enemy->AimOut();
+	}
+
+	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+}
+
+FString UBTTask_FireWeapon::GetStaticDescription() const {
+	if (SuppressTime > 0.0f) {
+		return FString::Printf(TEXT("Suppress %s for %.1fs"), *GetSelectedBlackboardKey().ToString(), SuppressTime);
+	}
+	return FString::Printf(TEXT("Engage %s, %d shots"), *GetSelectedBlackboardKey().ToString(), BurstCount);
+}
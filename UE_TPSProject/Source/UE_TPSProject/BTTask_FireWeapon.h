@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "BTTask_FireWeapon.generated.h"
+
+struct FBTFireWeaponMemory
+{
+	/** Time before the next shot */
+	float Cooldown;
+	float SuppressLeft;
+	int32 ShotsLeft;
+	/** The task aimed in itself, an aim started by another node is left alone when it ends */
+	bool bAimedByTask;
+};
+
+/**
+ * Faces the blackboard target and fires the enemy weapon at its rate.
+ * Engage: fires BurstCount shots at an actor. Suppress: keeps firing at a location, e.g. the last
+ * known player location, for SuppressTime. Only ticks while running.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UBTTask_FireWeapon : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_FireWeapon();
+
+	/** Shots fired before the task succeeds */
+	UPROPERTY(EditAnywhere, Category = "Fire", meta = (ClampMin = "0"))
+	int32 BurstCount = 3;
+
+	/** Seconds of fire at the target, on top of the burst */
+	UPROPERTY(EditAnywhere, Category = "Fire", meta = (ClampMin = "0.0"))
+	float SuppressTime = 0.0f;
+
+	/** Aim in when the task starts and out when it ends, unless the enemy was already aiming */
+	UPROPERTY(EditAnywhere, Category = "Fire")
+	bool bAimWhileFiring = true;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
+};
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTTask_PatrolStep.h"
+
+#include "Enemy.h"
+#include "EnemyPath.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTTask_PatrolStep::UBTTask_PatrolStep() {
+	NodeName = "Patrol Step";
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_PatrolStep, BlackboardKey));
+}
+
+EBTNodeResult::Type UBTTask_PatrolStep::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	if (!Enemy || !IsValid(Enemy->PathToPatrol)) {
+		return EBTNodeResult::Failed;
+	}
+
+	if (!bResumeOnly) {
+		Enemy->PathToPatrol->GoNextNode();
+	}
+
+	OwnerComp.GetBlackboardComponent()->SetValueAsVector(GetSelectedBlackboardKey(), Enemy->PathToPatrol->ActualPoint());
+	return EBTNodeResult::Succeeded;
+}
+
+FString UBTTask_PatrolStep::GetStaticDescription() const {
+	return FString::Printf(TEXT("%s: %s"), bResumeOnly ? TEXT("Resume patrol") : TEXT("Next patrol point"), *GetSelectedBlackboardKey().ToString());
+}
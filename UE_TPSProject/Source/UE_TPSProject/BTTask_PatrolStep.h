@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "BTTask_PatrolStep.generated.h"
+
+/**
+ * Moves the patrol of the enemy to the next point of its AEnemyPath and writes the point location
+ * in the blackboard key, for a following Move To. Finishes instantly.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UBTTask_PatrolStep : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_PatrolStep();
+
+	/** Write the actual point without moving to the next one, to resume a patrol */
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	bool bResumeOnly = false;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual FString GetStaticDescription() const override;
+};
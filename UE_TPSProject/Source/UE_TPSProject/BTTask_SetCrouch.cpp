@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTTask_SetCrouch.h"
+
+#include "Enemy.h"
+#include "AIController.h"
+
+UBTTask_SetCrouch::UBTTask_SetCrouch() {
+	NodeName = "Set Crouch";
+}
+
+EBTNodeResult::Type UBTTask_SetCrouch::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	if (!Enemy) {
+		return EBTNodeResult::Failed;
+	}
+
+	if (bCrouch) {
+		Enemy->CrouchMe();
+	} else {
+		Enemy->UncrouchMe();
+	}
+	return EBTNodeResult::Succeeded;
+}
+
+FString UBTTask_SetCrouch::GetStaticDescription() const {
+	return bCrouch ? TEXT("Crouch") : TEXT("Stand up");
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_SetCrouch.generated.h"
+
+/** Crouches or stands up the enemy, finishes instantly */
+UCLASS()
+class UE_TPSPROJECT_API UBTTask_SetCrouch : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_SetCrouch();
+
+	UPROPERTY(EditAnywhere, Category = "Cover")
+	bool bCrouch = true;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual FString GetStaticDescription() const override;
+};
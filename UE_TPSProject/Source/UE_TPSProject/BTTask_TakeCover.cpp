@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BTTask_TakeCover.h"
+
+#include "Enemy.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+UBTTask_TakeCover::UBTTask_TakeCover() {
+	NodeName = "Take Cover";
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_TakeCover, BlackboardKey));
+	ThreatKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_TakeCover, ThreatKey), AActor::StaticClass());
+	ThreatKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_TakeCover, ThreatKey));
+}
+
+void UBTTask_TakeCover::InitializeFromAsset(UBehaviorTree& Asset) {
+	Super::InitializeFromAsset(Asset);
+
+	if (UBlackboardData* Blackboard = GetBlackboardAsset()) {
+		ThreatKey.ResolveSelectedKey(*Blackboard);
+	}
+}
+
+EBTNodeResult::Type UBTTask_TakeCover::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) {
+	AEnemy* Enemy = Cast<AEnemy>(OwnerComp.GetAIOwner()->GetPawn());
+	UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+
+	FVector ThreatLocation;
+	if (!Enemy || !Blackboard->GetLocationFromEntry(ThreatKey.SelectedKeyName, ThreatLocation)) {
+		return EBTNodeResult::Failed;
+	}
+
+	FVector CoverLocation;
+	if (!Enemy->FindCover(ThreatLocation, SearchRadius, CoverLocation)) {
+		return EBTNodeResult::Failed;
+	}
+
+	Blackboard->SetValueAsVector(GetSelectedBlackboardKey(), CoverLocation);
+	return EBTNodeResult::Succeeded;
+}
+
+FString UBTTask_TakeCover::GetStaticDescription() const {
+	return FString::Printf(TEXT("Cover from %s in %.0f: %s"), *ThreatKey.SelectedKeyName.ToString(), SearchRadius, *GetSelectedBlackboardKey().ToString());
+}
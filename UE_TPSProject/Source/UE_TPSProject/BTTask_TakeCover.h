@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "BTTask_TakeCover.generated.h"
+
+/**
+ * Looks up the nearest baked cover protecting from the threat and writes its location in the
+ * blackboard key, for a following Move To. Fails if no cover is in reach. Finishes instantly.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UBTTask_TakeCover : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_TakeCover();
+
+	/** Actor or location to hide from */
+	UPROPERTY(EditAnywhere, Category = "Cover")
+	FBlackboardKeySelector ThreatKey;
+
+	UPROPERTY(EditAnywhere, Category = "Cover", meta = (ClampMin = "0.0"))
+	float SearchRadius = 1500.0f;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual FString GetStaticDescription() const override;
+};
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BotController.h"
+
+#include "Enemy.h"
+#include "GameEventSubsystem.h"
+#include "HealthComponent.h"
+#include "UE_TPSProjectCharacter.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
+
+ABotController::ABotController() {
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Bots count as players for the game mode and the replication load
+	bWantsPlayerState = true;
+}
+
+void ABotController::OnPossess(APawn* InPawn) {
+	Super::OnPossess(InPawn);
+
+	Bot = Cast<AUE_TPSProjectCharacter>(InPawn);
+	if (!Bot) {
+		return;
+	}
+
+	Input.MoveForward = AUE_TPSProjectCharacter::FindAxis(TEXT("MoveForward"));
+	Input.MoveRight = AUE_TPSProjectCharacter::FindAxis(TEXT("MoveRight"));
+	Input.SprintPressed = AUE_TPSProjectCharacter::FindAction(TEXT("Sprint"), IE_Pressed);
+	Input.SprintReleased = AUE_TPSProjectCharacter::FindAction(TEXT("Sprint"), IE_Released);
+	Input.CrouchPressed = AUE_TPSProjectCharacter::FindAction(TEXT("Crouch"), IE_Pressed);
+	Input.CrouchReleased = AUE_TPSProjectCharacter::FindAction(TEXT("Crouch"), IE_Released);
+	Input.AimPressed = AUE_TPSProjectCharacter::FindAction(TEXT("Aim"), IE_Pressed);
+	Input.AimReleased = AUE_TPSProjectCharacter::FindAction(TEXT("Aim"), IE_Released);
+	Input.FirePressed = AUE_TPSProjectCharacter::FindAction(TEXT("Fire"), IE_Pressed);
+	Input.FireReleased = AUE_TPSProjectCharacter::FindAction(TEXT("Fire"), IE_Released);
+	Input.Reload = AUE_TPSProjectCharacter::FindAction(TEXT("Reload"), IE_Pressed);
+
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Subscribe(EGameEvent::HealthZero, this, Bot, FGameEventDelegate::CreateWeakLambda(this, [this](const FGameEvent&) {
+			StopBot();
+		}));
+	}
+
+	// Spread the decisions so bots spawned together don't think on the same frame
+	GetWorldTimerManager().SetTimer(ThinkTimer, this, &ABotController::Think, ThinkInterval, true, FMath::FRandRange(0.0f, ThinkInterval));
+}
+
+void ABotController::OnUnPossess() {
+	StopBot();
+	Super::OnUnPossess();
+}
+
+void ABotController::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (!Bot) {
+		return;
+	}
+
+	if (bIsFiring) {
+		BurstTimeLeft -= DeltaTime;
+		if (BurstTimeLeft <= 0.0f) {
+			SetButton(bIsFiring, false, Input.FirePressed, Input.FireReleased);
+		}
+	}
+
+	if (Target.IsValid() || !bHasDestination) {
+		return;
+	}
+
+	// Axis input is consumed every frame, like a held stick
+	FVector ToDestination = Destination - Bot->GetActorLocation();
+	ToDestination.Z = 0.0f;
+	if (ToDestination.SizeSquared() < FMath::Square(100.0f)) {
+		bHasDestination = false;
+		return;
+	}
+
+	FVector Local = FRotator(0.0f, GetControlRotation().Yaw, 0.0f).UnrotateVector(ToDestination.GetSafeNormal());
+	Bot->DispatchAxis(Input.MoveForward, Local.X);
+	Bot->DispatchAxis(Input.MoveRight, Local.Y);
+}
+
+void ABotController::Think() {
+	if (!Bot) {
+		return;
+	}
+
+	AEnemy* Enemy = FindNearestEnemy();
+	Target = Enemy;
+
+	if (Enemy) {
+		Engage(Enemy);
+	} else {
+		Wander();
+	}
+}
+
+void ABotController::Engage(AEnemy* Enemy) {
+	SetButton(bIsSprinting, false, Input.SprintPressed, Input.SprintReleased);
+	SetFocus(Enemy);
+	SetButton(bIsAiming, true, Input.AimPressed, Input.AimReleased);
+
+	if (FMath::FRand() < StanceChangeChance) {
+		SetButton(bIsCrouching, !bIsCrouching, Input.CrouchPressed, Input.CrouchReleased);
+	}
+
+	if (Bot->MagCounter() <= 0) {
+		SetButton(bIsFiring, false, Input.FirePressed, Input.FireReleased);
+		Bot->DispatchAction(Input.Reload);
+		return;
+	}
+
+	if (!bIsFiring && !Bot->IsReloading()) {
+		BurstTimeLeft = BurstDuration;
+		SetButton(bIsFiring, true, Input.FirePressed, Input.FireReleased);
+	}
+}
+
+void ABotController::Wander() {
+	SetButton(bIsFiring, false, Input.FirePressed, Input.FireReleased);
+	SetButton(bIsAiming, false, Input.AimPressed, Input.AimReleased);
+	SetButton(bIsCrouching, false, Input.CrouchPressed, Input.CrouchReleased);
+
+	if (!bHasDestination) {
+		UNavigationSystemV1* Navigation = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		FNavLocation Point;
+		bHasDestination = Navigation && Navigation->GetRandomReachablePointInRadius(Bot->GetActorLocation(), WanderRadius, Point);
+		Destination = Point.Location;
+	}
+
+	// The control rotation follows the focal point, the movement axes are relative to it
+	if (bHasDestination) {
+		SetFocalPoint(Destination);
+	}
+
+	if (FMath::FRand() < StanceChangeChance) {
+		SetButton(bIsSprinting, !bIsSprinting, Input.SprintPressed, Input.SprintReleased);
+	}
+}
+
+AEnemy* ABotController::FindNearestEnemy() const {
+	AEnemy* Nearest = nullptr;
+	float NearestDistance = FMath::Square(EngageRange);
+	FVector Location = Bot->GetActorLocation();
+
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It) {
+		AEnemy* Enemy = *It;
+		float Distance = FVector::DistSquared(Location, Enemy->GetActorLocation());
+		if (Distance >= NearestDistance || Enemy->GetHealthComponent()->HealthPercentage() <= 0.0f) {
+			continue;
+		}
+
+		if (LineOfSightTo(Enemy)) {
+			Nearest = Enemy;
+			NearestDistance = Distance;
+		}
+	}
+	return Nearest;
+}
+
+void ABotController::SetButton(bool& bState, bool bPressed, int32 PressedAction, int32 ReleasedAction) {
+	if (bState == bPressed) {
+		return;
+	}
+
+	bState = bPressed;
+	Bot->DispatchAction(bPressed ? PressedAction : ReleasedAction);
+}
+
+void ABotController::StopBot() {
+	if (Bot) {
+		SetButton(bIsFiring, false, Input.FirePressed, Input.FireReleased);
+	}
+	GetWorldTimerManager().ClearTimer(ThinkTimer);
+	ClearFocus(EAIFocusPriority::Gameplay);
+
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Unsubscribe(this);
+	}
+
+	Bot = nullptr;
+	Target = nullptr;
+	bHasDestination = false;
+}
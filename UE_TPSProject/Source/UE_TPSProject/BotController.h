@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "BotController.generated.h"
+
+class AEnemy;
+class AUE_TPSProjectCharacter;
+
+/**
+ * Drives an AUE_TPSProjectCharacter through the same input handlers as a human player,
+ * used to load a server with many players for soak tests.
+ */
+UCLASS()
+class UE_TPSPROJECT_API ABotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	ABotController();
+
+	/** Seconds between two decisions, the input itself is applied every tick */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float ThinkInterval = 0.25f;
+
+	/** Enemies further than this are ignored */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float EngageRange = 4000.0f;
+
+	/** Radius of the random destinations picked while no enemy is in range */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float WanderRadius = 3000.0f;
+
+	/** Seconds the fire button is held in each burst */
+	UPROPERTY(EditAnywhere, Category = "Bot")
+	float BurstDuration = 0.6f;
+
+	/** Chance, per decision, to crouch while engaging or to sprint while wandering */
+	UPROPERTY(EditAnywhere, Category = "Bot", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float StanceChangeChance = 0.1f;
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+private:
+	UPROPERTY(Transient)
+	AUE_TPSProjectCharacter* Bot;
+
+	TWeakObjectPtr<AEnemy> Target;
+
+	FVector Destination = FVector::ZeroVector;
+
+	bool bHasDestination = false;
+
+	bool bIsAiming = false;
+
+	bool bIsFiring = false;
+
+	bool bIsSprinting = false;
+
+	bool bIsCrouching = false;
+
+	float BurstTimeLeft = 0.0f;
+
+	FTimerHandle ThinkTimer;
+
+	/** Input binding indices of the character, resolved once */
+	struct FBotInput
+	{
+		int32 MoveForward;
+		int32 MoveRight;
+		int32 SprintPressed;
+		int32 SprintReleased;
+		int32 CrouchPressed;
+		int32 CrouchReleased;
+		int32 AimPressed;
+		int32 AimReleased;
+		int32 FirePressed;
+		int32 FireReleased;
+		int32 Reload;
+	};
+
+	FBotInput Input;
+
+	/** Pick a target or a destination and the stance to use */
+	void Think();
+
+	void Engage(AEnemy* Enemy);
+
+	void Wander();
+
+	AEnemy* FindNearestEnemy() const;
+
+	/** Press or release a button, only dispatching the action when its state changes */
+	void SetButton(bool& bState, bool bPressed, int32 PressedAction, int32 ReleasedAction);
+
+	/** Forget the bot when its character dies */
+	void StopBot();
+};
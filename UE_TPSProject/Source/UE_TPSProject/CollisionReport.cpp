@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CollisionReport.h"
+
+#include "EngineUtils.h"
+#include "Algo/Count.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorldAndArgs CollisionReportCommand(
+	TEXT("TPS.CollisionReport"),
+	TEXT("Print the broadphase proxies and the scene query time per actor class. Usage: TPS.CollisionReport [reset]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (Args.Num() > 0 && Args[0] == TEXT("reset")) {
+			FCollisionReport::Reset();
+		} else if (World) {
+			FCollisionReport::Dump(World, *GLog);
+		}
+	}));
+
+namespace CollisionReport
+{
+	struct FQueryStats
+	{
+		uint32 Count = 0;
+		uint64 Cycles = 0;
+	};
+
+	/** By class name, a class unloaded since the query still reads in the report */
+	static TMap<FName, FQueryStats> Queries;
+
+	struct FFootprint
+	{
+		int32 Actors = 0;
+		int32 Primitives = 0;
+		int32 Proxies = 0;
+		int32 MovableProxies = 0;
+	};
+
+	/** Bodies the primitive has in the physics scene, one broadphase proxy each */
+	static int32 CountProxies(const UPrimitiveComponent* Primitive) {
+		auto CountValid = [](const TArray<FBodyInstance*>& Bodies) {
+			return Algo::CountIf(Bodies, [](const FBodyInstance* Body) { return Body && Body->IsValidBodyInstance(); });
+		};
+
+		if (const USkeletalMeshComponent* Skeletal = Cast<USkeletalMeshComponent>(Primitive)) {
+			return CountValid(Skeletal->Bodies);
+		}
+		if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Primitive)) {
+			return CountValid(Instanced->InstanceBodies);
+		}
+		const FBodyInstance* Body = Primitive->GetBodyInstance();
+		return Body && Body->IsValidBodyInstance() ? 1 : 0;
+	}
+}
+
+using namespace CollisionReport;
+
+void FCollisionReport::RecordQuery(const UObject* Issuer, uint64 Cycles) {
+	if (!Issuer || !IsInGameThread()) {
+		return;
+	}
+
+	FQueryStats& Stats = Queries.FindOrAdd(Issuer->GetClass()->GetFName());
+	Stats.Count++;
+	Stats.Cycles += Cycles;
+}
+
+void FCollisionReport::Reset() {
+	Queries.Reset();
+}
+
+void FCollisionReport::Dump(UWorld* World, FOutputDevice& Ar) {
+	TMap<FName, FFootprint> Footprints;
+	FFootprint Total;
+
+	for (TActorIterator<AActor> It(World); It; ++It) {
+		FFootprint& Footprint = Footprints.FindOrAdd(It->GetClass()->GetFName());
+		Footprint.Actors++;
+		Total.Actors++;
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [&Footprint, &Total](const UPrimitiveComponent* Primitive) {
+			if (!Primitive->IsPhysicsStateCreated()) {
+				return;
+			}
+
+			int32 Proxies = CountProxies(Primitive);
+			int32 Movable = Primitive->Mobility == EComponentMobility::Movable ? Proxies : 0;
+			for (FFootprint* Counts : {&Footprint, &Total}) {
+				Counts->Primitives++;
+				Counts->Proxies += Proxies;
+				Counts->MovableProxies += Movable;
+			}
+		});
+	}
+
+	Footprints.ValueSort([](const FFootprint& A, const FFootprint& B) { return A.Proxies > B.Proxies; });
+
+	Ar.Logf(TEXT("Broadphase proxies: %d in %d primitives, %d movable, %d actors"), Total.Proxies, Total.Primitives, Total.MovableProxies, Total.Actors);
+	for (const TPair<FName, FFootprint>& Pair : Footprints) {
+		if (Pair.Value.Proxies > 0) {
+			Ar.Logf(TEXT("  %-40s %5d actors %6d proxies %6d movable, %.1f per actor"), *Pair.Key.ToString(), Pair.Value.Actors,
+				Pair.Value.Proxies, Pair.Value.MovableProxies, static_cast<float>(Pair.Value.Proxies) / Pair.Value.Actors);
+		}
+	}
+
+	Queries.ValueSort([](const FQueryStats& A, const FQueryStats& B) { return A.Cycles > B.Cycles; });
+
+	Ar.Logf(TEXT("Scene queries since the last reset:"));
+	for (const TPair<FName, FQueryStats>& Pair : Queries) {
+		double Milliseconds = FPlatformTime::ToMilliseconds64(Pair.Value.Cycles);
+		Ar.Logf(TEXT("  %-40s %8u queries %10.3f ms, %.2f us per query"), *Pair.Key.ToString(), Pair.Value.Count,
+			Milliseconds, Milliseconds * 1000.0 / FMath::Max<uint32>(Pair.Value.Count, 1));
+	}
+}
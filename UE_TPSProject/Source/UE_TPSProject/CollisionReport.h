@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Collision footprint of the world, printed per actor class by TPS.CollisionReport: the broadphase
+ * proxies (bodies of the primitives that have a physics state) and how many of them are movable, and
+ * the scene queries issued by the class with the time they took, as measured by SCOPE_COLLISION_QUERY.
+ */
+class UE_TPSPROJECT_API FCollisionReport
+{
+public:
+	/** Charge a query of Cycles to the class of Issuer, game thread only */
+	static void RecordQuery(const UObject* Issuer, uint64 Cycles);
+
+	static void Dump(UWorld* World, FOutputDevice& Ar);
+
+	/** Clear the query times */
+	static void Reset();
+};
+
+#if !UE_BUILD_SHIPPING
+
+/** Time the scene queries made while alive and charge them to the class of Issuer */
+struct FScopedCollisionQuery
+{
+	explicit FScopedCollisionQuery(const UObject* InIssuer) : Issuer(InIssuer), StartCycles(FPlatformTime::Cycles64()) {}
+
+	~FScopedCollisionQuery() { FCollisionReport::RecordQuery(Issuer, FPlatformTime::Cycles64() - StartCycles); }
+
+private:
+	const UObject* Issuer;
+	uint64 StartCycles;
+};
+
+#define SCOPE_COLLISION_QUERY(Issuer) FScopedCollisionQuery PREPROCESSOR_JOIN(CollisionQueryScope, __LINE__)(Issuer)
+
+#else
+
+#define SCOPE_COLLISION_QUERY(Issuer)
+
+#endif
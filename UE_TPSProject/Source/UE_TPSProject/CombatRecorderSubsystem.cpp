@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatRecorderSubsystem.h"
+
+#include "UE_TPSProjectCharacter.h"
+#include "HAL/PlatformFileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+
+static FAutoConsoleCommandWithWorldAndArgs CombatRecordCommand(
+	TEXT("TPS.Record"),
+	TEXT("Record the player input and the combat events. Usage: TPS.Record <file>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		UCombatRecorderSubsystem* Recorder = World ? World->GetSubsystem<UCombatRecorderSubsystem>() : nullptr;
+		if (Recorder && Args.Num() > 0) {
+			Recorder->StartRecording(Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CombatStopRecordCommand(
+	TEXT("TPS.StopRecord"),
+	TEXT("Stop the recording started with TPS.Record"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (UCombatRecorderSubsystem* Recorder = World ? World->GetSubsystem<UCombatRecorderSubsystem>() : nullptr) {
+			Recorder->StopRecording();
+		}
+	}));
+
+TStatId UCombatRecorderSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatRecorderSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatRecorderSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("CombatReplay="), Path)) {
+		StartReplay(Path);
+	} else if (FParse::Value(FCommandLine::Get(), TEXT("CombatRecord="), Path)) {
+		StartRecording(Path);
+	}
+}
+
+void UCombatRecorderSubsystem::Deinitialize() {
+	StopRecording();
+	Super::Deinitialize();
+}
+
+void UCombatRecorderSubsystem::Tick(float DeltaTime) {
+	if (IsRecording()) {
+		WriteFrame(DeltaTime);
+	} else if (IsReplaying() && !ReplayFrame()) {
+		StopReplay();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Recording
+
+void UCombatRecorderSubsystem::StartRecording(const FString& Path) {
+	StopRecording();
+
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path);
+	if (!FileHandle) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot open the combat record %s"), *Path);
+		return;
+	}
+
+	Buffer.Reset(FlushSize * 2);
+	FMemory::Memzero(PreviousAxes);
+	FMemory::Memzero(FrameAxes);
+
+	uint32 Magic = StreamMagic;
+	uint16 Version = StreamVersion;
+	Buffer.Append(reinterpret_cast<uint8*>(&Magic), sizeof(Magic));
+	Buffer.Append(reinterpret_cast<uint8*>(&Version), sizeof(Version));
+}
+
+void UCombatRecorderSubsystem::StopRecording() {
+	if (!FileHandle) {
+		return;
+	}
+
+	Flush();
+	delete FileHandle;
+	FileHandle = nullptr;
+}
+
+void UCombatRecorderSubsystem::RecordAxis(int32 Axis, float Value) {
+	if (Axis >= 0 && Axis < MaxAxes) {
+		FrameAxes[Axis] = FMath::RoundToInt(Value * AxisScale);
+	}
+}
+
+void UCombatRecorderSubsystem::RecordAction(int32 Action) {
+	if (IsRecording()) {
+		WriteVarInt(FrameActions, Action);
+		NumFrameActions++;
+	}
+}
+
+void UCombatRecorderSubsystem::RecordEvent(const UObject* WorldContext, ECombatRecordEvent Event, const AActor* Actor, float Value) {
+	UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	UCombatRecorderSubsystem* Recorder = World ? World->GetSubsystem<UCombatRecorderSubsystem>() : nullptr;
+
+	if (!Recorder || !Recorder->IsRecording()) {
+		return;
+	}
+
+	// Actor names of placed actors are stable between runs, their hash identifies the actor
+	Recorder->FrameEvents.Add(static_cast<uint8>(Event));
+	TStringBuilder<NAME_SIZE> ActorName;
+	if (Actor) {
+		Actor->GetFName().AppendString(ActorName);
+	}
+	WriteVarInt(Recorder->FrameEvents, Actor ? FCrc::StrCrc32(*ActorName) : 0);
+	WriteZigZag(Recorder->FrameEvents, FMath::RoundToInt(Value * 100.0f));
+	Recorder->NumFrameEvents++;
+}
+
+void UCombatRecorderSubsystem::WriteFrame(float DeltaTime) {
+	// Delta time in microseconds
+	WriteVarInt(Buffer, static_cast<uint32>(FMath::RoundToInt(DeltaTime * 1000000.0f)));
+
+	// Mask of the changed axes, followed by their deltas
+	uint32 ChangedMask = 0;
+	for (int32 Axis = 0; Axis < MaxAxes; Axis++) {
+		if (FrameAxes[Axis] != PreviousAxes[Axis]) {
+			ChangedMask |= 1u << Axis;
+		}
+	}
+
+	WriteVarInt(Buffer, ChangedMask);
+	for (int32 Axis = 0; Axis < MaxAxes; Axis++) {
+		if (ChangedMask & (1u << Axis)) {
+			WriteZigZag(Buffer, FrameAxes[Axis] - PreviousAxes[Axis]);
+			PreviousAxes[Axis] = FrameAxes[Axis];
+		}
+	}
+
+	WriteVarInt(Buffer, NumFrameActions);
+	Buffer.Append(FrameActions);
+	WriteVarInt(Buffer, NumFrameEvents);
+	Buffer.Append(FrameEvents);
+
+	FrameActions.Reset();
+	FrameEvents.Reset();
+	NumFrameActions = 0;
+	NumFrameEvents = 0;
+
+	if (Buffer.Num() >= FlushSize) {
+		Flush();
+	}
+}
+
+void UCombatRecorderSubsystem::Flush() {
+	if (FileHandle && Buffer.Num() > 0) {
+		FileHandle->Write(Buffer.GetData(), Buffer.Num());
+	}
+	Buffer.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Replay
+
+void UCombatRecorderSubsystem::StartReplay(const FString& Path) {
+	if (!FFileHelper::LoadFileToArray(ReplayStream, *Path) || ReplayStream.Num() < 6) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot read the combat record %s"), *Path);
+		return;
+	}
+
+	uint32 Magic;
+	uint16 Version;
+	FMemory::Memcpy(&Magic, ReplayStream.GetData(), sizeof(Magic));
+	FMemory::Memcpy(&Version, ReplayStream.GetData() + sizeof(Magic), sizeof(Version));
+	if (Magic != StreamMagic || Version != StreamVersion) {
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a supported combat record"), *Path);
+		return;
+	}
+
+	ReplayOffset = sizeof(Magic) + sizeof(Version);
+	FMemory::Memzero(PreviousAxes);
+
+	// Run the recorded frames back to back, as fast as possible, and capture the stats
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	GEngine->Exec(GetWorld(), TEXT("stat startfile"));
+}
+
+bool UCombatRecorderSubsystem::ReplayFrame() {
+	if (ReplayOffset >= ReplayStream.Num()) {
+		return false;
+	}
+
+	// The next engine frame uses the recorded delta time
+	FApp::SetFixedDeltaTime(ReadVarInt() / 1000000.0);
+
+	uint32 ChangedMask = ReadVarInt();
+	for (int32 Axis = 0; Axis < MaxAxes; Axis++) {
+		if (ChangedMask & (1u << Axis)) {
+			PreviousAxes[Axis] += ReadZigZag();
+		}
+	}
+
+	// The player pawn is spawned after the world begin play
+	if (!IsValid(ReplayCharacter)) {
+		ReplayCharacter = Cast<AUE_TPSProjectCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+	}
+
+	if (IsValid(ReplayCharacter)) {
+		for (int32 Axis = 0; Axis < AUE_TPSProjectCharacter::NumRecordedAxes(); Axis++) {
+			ReplayCharacter->DispatchAxis(Axis, PreviousAxes[Axis] / AxisScale);
+		}
+	}
+
+	uint32 NumActions = ReadVarInt();
+	for (uint32 Action = 0; Action < NumActions; Action++) {
+		int32 ActionIndex = ReadVarInt();
+		if (IsValid(ReplayCharacter)) {
+			ReplayCharacter->DispatchAction(ActionIndex);
+		}
+	}
+
+	// The events are what happened during the recording, the replay produces its own
+	uint32 NumEvents = ReadVarInt();
+	for (uint32 Event = 0; Event < NumEvents; Event++) {
+		ReplayOffset++;
+		ReadVarInt();
+		ReadZigZag();
+	}
+
+	return true;
+}
+
+void UCombatRecorderSubsystem::StopReplay() {
+	ReplayOffset = INDEX_NONE;
+	ReplayStream.Empty();
+
+	GEngine->Exec(GetWorld(), TEXT("stat stopfile"));
+	FApp::SetUseFixedTimeStep(false);
+	FApp::SetBenchmarking(false);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("ExitAfterReplay"))) {
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Encoding
+
+void UCombatRecorderSubsystem::WriteVarInt(TArray<uint8>& Out, uint32 Value) {
+	while (Value >= 0x80) {
+		Out.Add(static_cast<uint8>(Value | 0x80));
+		Value >>= 7;
+	}
+	Out.Add(static_cast<uint8>(Value));
+}
+
+void UCombatRecorderSubsystem::WriteZigZag(TArray<uint8>& Out, int32 Value) {
+	WriteVarInt(Out, (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31));
+}
+
+uint32 UCombatRecorderSubsystem::ReadVarInt() {
+	uint32 Value = 0;
+	int32 Shift = 0;
+
+	while (ReplayOffset < ReplayStream.Num() && Shift < 35) {
+		uint8 Byte = ReplayStream[ReplayOffset++];
+		Value |= static_cast<uint32>(Byte & 0x7F) << Shift;
+		if (!(Byte & 0x80)) {
+			break;
+		}
+		Shift += 7;
+	}
+	return Value;
+}
+
+int32 UCombatRecorderSubsystem::ReadZigZag() {
+	uint32 Value = ReadVarInt();
+	return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+}
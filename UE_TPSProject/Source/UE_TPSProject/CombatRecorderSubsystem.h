@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatRecorderSubsystem.generated.h"
+
+class AUE_TPSProjectCharacter;
+class IFileHandle;
+
+/** Combat events stored next to the player input */
+enum class ECombatRecordEvent : uint8
+{
+	Fire,
+	Damage,
+	Alert
+};
+
+/**
+ * Records the player input and the combat events in a compact binary stream, and plays it back.
+ * Every frame stores its delta time, the axes that changed since the previous frame as zigzag
+ * varint deltas, the pressed actions and the combat events.
+ * Recording starts with -CombatRecord=<file> or the TPS.Record command.
+ * Playback starts with -CombatReplay=<file>: the frames run with the recorded delta times, as fast
+ * as the machine allows, with the stats captured to a file, then the game exits.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UCombatRecorderSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartRecording(const FString& Path);
+
+	void StopRecording();
+
+	bool IsRecording() const { return FileHandle != nullptr; }
+
+	bool IsReplaying() const { return ReplayOffset != INDEX_NONE; }
+
+	/** Store the value of a recorded axis for the current frame */
+	void RecordAxis(int32 Axis, float Value);
+
+	/** Store a recorded action for the current frame */
+	void RecordAction(int32 Action);
+
+	/** Store a combat event if the world is recording, cheap no-op otherwise */
+	static void RecordEvent(const UObject* WorldContext, ECombatRecordEvent Event, const AActor* Actor, float Value = 0.0f);
+
+private:
+	static constexpr uint32 StreamMagic = 0x52535054; // "TPSR"
+	static constexpr uint16 StreamVersion = 1;
+	/** Axis values are stored in 1/4096 steps */
+	static constexpr float AxisScale = 4096.0f;
+	static constexpr int32 MaxAxes = 16;
+	static constexpr int32 FlushSize = 64 * 1024;
+
+	IFileHandle* FileHandle = nullptr;
+
+	/** Encoded bytes waiting to be written */
+	TArray<uint8> Buffer;
+
+	/** Axes of the frame being recorded and of the previous one */
+	int32 FrameAxes[MaxAxes] = {};
+	int32 PreviousAxes[MaxAxes] = {};
+
+	/** Actions and events of the frame being recorded, already encoded */
+	TArray<uint8> FrameActions;
+	TArray<uint8> FrameEvents;
+	uint32 NumFrameActions = 0;
+	uint32 NumFrameEvents = 0;
+
+	/** Recorded stream being played and the read position, INDEX_NONE when not replaying */
+	TArray<uint8> ReplayStream;
+	int32 ReplayOffset = INDEX_NONE;
+
+	UPROPERTY(Transient)
+	AUE_TPSProjectCharacter* ReplayCharacter;
+
+	void WriteFrame(float DeltaTime);
+
+	void Flush();
+
+	void StartReplay(const FString& Path);
+
+	/** Decode one frame and apply its input, false at the end of the stream */
+	bool ReplayFrame();
+
+	void StopReplay();
+
+	static void WriteVarInt(TArray<uint8>& Out, uint32 Value);
+
+	static void WriteZigZag(TArray<uint8>& Out, int32 Value);
+
+	uint32 ReadVarInt();
+
+	int32 ReadZigZag();
+};
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombatTelemetry.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace CombatTelemetry;
+
+FCombatTelemetry::FCombatTelemetry()
+{
+	FString Path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("CombatTelemetry="), Path)) {
+		uint32 Capacity = 1 << 20;
+		FParse::Value(FCommandLine::Get(), TEXT("CombatTelemetryRecords="), Capacity);
+		Open(Path, FMath::Max<uint32>(Capacity, 1024));
+	}
+}
+
+FCombatTelemetry::~FCombatTelemetry()
+{
+	Close();
+}
+
+FCombatTelemetry& FCombatTelemetry::Get() {
+	static FCombatTelemetry Instance;
+	return Instance;
+}
+
+void FCombatTelemetry::Record(ERecordType Type, const AActor* Source, const AActor* Target, float Value) {
+	FCombatTelemetry& Telemetry = Get();
+	if (Telemetry.IsOpen()) {
+		Telemetry.Write(Type, Source ? Source->GetUniqueID() : 0, Target ? Target->GetUniqueID() : 0, Value);
+	}
+}
+
+void FCombatTelemetry::Write(ERecordType Type, uint32 Source, uint32 Target, float Value) {
+	if (!Header) {
+		return;
+	}
+
+	// The format header uses the standard integer types, which are not the engine ones on every platform
+	int64 Index = FPlatformAtomics::InterlockedIncrement(reinterpret_cast<volatile int64*>(&Header->WriteIndex)) - 1;
+	FRecord& Slot = Records[Index % Header->Capacity];
+	volatile int64* Commit = reinterpret_cast<volatile int64*>(&Slot.Commit);
+
+	// Readers skip the slot while it is being rewritten
+	FPlatformAtomics::AtomicStore(Commit, 0);
+	Slot.Time = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+	Slot.Source = Source;
+	Slot.Target = Target;
+	Slot.Value = Value;
+	Slot.Type = static_cast<uint8>(Type);
+	FPlatformAtomics::AtomicStore(Commit, Index + 1);
+}
+
+bool FCombatTelemetry::Open(const FString& Path, uint32 Capacity) {
+	MappedSize = sizeof(FHeader) + static_cast<uint64>(Capacity) * sizeof(FRecord);
+	void* Mapped = nullptr;
+
+#if PLATFORM_WINDOWS
+	HANDLE File = CreateFileW(*Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READWRITE, static_cast<DWORD>(MappedSize >> 32), static_cast<DWORD>(MappedSize), nullptr);
+	Mapped = Mapping ? MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, MappedSize) : nullptr;
+	if (!Mapped) {
+		if (Mapping) {
+			CloseHandle(Mapping);
+		}
+		CloseHandle(File);
+		return false;
+	}
+	FileHandle = File;
+	MappingHandle = Mapping;
+#else
+	FileDescriptor = open(TCHAR_TO_UTF8(*Path), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (FileDescriptor < 0) {
+		return false;
+	}
+
+	if (ftruncate(FileDescriptor, MappedSize) != 0) {
+		close(FileDescriptor);
+		FileDescriptor = -1;
+		return false;
+	}
+
+	Mapped = mmap(nullptr, MappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, FileDescriptor, 0);
+	if (Mapped == MAP_FAILED) {
+		close(FileDescriptor);
+		FileDescriptor = -1;
+		return false;
+	}
+#endif
+
+	// The file is created zeroed, only the header needs values
+	Header = static_cast<FHeader*>(Mapped);
+	Records = reinterpret_cast<FRecord*>(Header + 1);
+	Header->Magic = Magic;
+	Header->Version = Version;
+	Header->RecordSize = sizeof(FRecord);
+	Header->Capacity = Capacity;
+	Header->WriteIndex = 0;
+	StartTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Log, TEXT("Combat telemetry written to %s (%u records)"), *Path, Capacity);
+	return true;
+}
+
+void FCombatTelemetry::Close() {
+	if (!Header) {
+		return;
+	}
+
+#if PLATFORM_WINDOWS
+	FlushViewOfFile(Header, 0);
+	UnmapViewOfFile(Header);
+	CloseHandle(MappingHandle);
+	CloseHandle(FileHandle);
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+#else
+	msync(Header, MappedSize, MS_SYNC);
+	munmap(Header, MappedSize);
+	close(FileDescriptor);
+	FileDescriptor = -1;
+#endif
+
+	Header = nullptr;
+	Records = nullptr;
+}
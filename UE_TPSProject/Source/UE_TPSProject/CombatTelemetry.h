@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatTelemetryFormat.h"
+
+/**
+ * Appends fixed-size combat records to a memory-mapped ring buffer file.
+ * Any thread can write: a record slot is reserved with an atomic increment and published by
+ * writing its commit index last, no lock and no allocation on the hot path.
+ * Enabled with -CombatTelemetry=<file> [-CombatTelemetryRecords=<count>].
+ */
+class UE_TPSPROJECT_API FCombatTelemetry
+{
+public:
+	~FCombatTelemetry();
+
+	static FCombatTelemetry& Get();
+
+	bool IsOpen() const { return Header != nullptr; }
+
+	void Write(CombatTelemetry::ERecordType Type, uint32 Source, uint32 Target, float Value);
+
+	/** Write a record if the telemetry is enabled, actors are identified by their object id */
+	static void Record(CombatTelemetry::ERecordType Type, const AActor* Source, const AActor* Target = nullptr, float Value = 0.0f);
+
+private:
+	FCombatTelemetry();
+
+	bool Open(const FString& Path, uint32 Capacity);
+
+	void Close();
+
+	CombatTelemetry::FHeader* Header = nullptr;
+	CombatTelemetry::FRecord* Records = nullptr;
+	uint64 MappedSize = 0;
+	double StartTime = 0.0;
+
+#if PLATFORM_WINDOWS
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#else
+	int32 FileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Layout of the combat telemetry file. Plain C++ on purpose: it is shared with the offline analyzer
+// in Tools/TelemetryAnalyzer, which does not link against the engine.
+
+#include <cstdint>
+
+namespace CombatTelemetry
+{
+	constexpr uint32_t Magic = 0x4C545354; // "TSTL"
+	constexpr uint16_t Version = 1;
+
+	enum class ERecordType : uint8_t
+	{
+		MatchStart,
+		Shot,
+		Hit,
+		Damage,
+		Alert,
+		Death
+	};
+
+	struct FHeader
+	{
+		uint32_t Magic;
+		uint16_t Version;
+		uint16_t RecordSize;
+		uint32_t Capacity;
+		uint32_t Reserved;
+		/** Number of records ever reserved, the next record goes in WriteIndex % Capacity */
+		volatile int64_t WriteIndex;
+	};
+
+	/** Fixed size record. Commit is written last: it holds the record index + 1 once the record is complete */
+	struct FRecord
+	{
+		volatile int64_t Commit;
+		/** Seconds since the telemetry was opened */
+		float Time;
+		uint32_t Source;
+		uint32_t Target;
+		float Value;
+		uint8_t Type;
+		uint8_t Padding[7];
+	};
+
+	static_assert(sizeof(FHeader) == 24, "Telemetry header layout changed");
+	static_assert(sizeof(FRecord) == 32, "Telemetry record layout changed");
+}
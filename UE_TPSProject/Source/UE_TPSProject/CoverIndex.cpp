@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoverIndex.h"
+
+#include "EngineUtils.h"
+
+ACoverIndex::ACoverIndex()
+{
+	// The index is read only at runtime
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+ACoverIndex* ACoverIndex::FindInWorld(const UWorld* World) {
+	if (!World) {
+		return nullptr;
+	}
+
+	TActorIterator<ACoverIndex> It(World);
+	return It ? *It : nullptr;
+}
+
+int32 ACoverIndex::CellCoordinate(float Value, float Origin, int32 GridSize) const {
+	return FMath::Clamp(FMath::FloorToInt((Value - Origin) / BakedCellSize), 0, GridSize - 1);
+}
+
+int32 ACoverIndex::FindNearestCover(const FVector& Location, float Radius, const FVector* ThreatLocation) const {
+	if (CoverPoints.Num() == 0) {
+		return INDEX_NONE;
+	}
+
+	int32 MinX = CellCoordinate(Location.X - Radius, GridOrigin.X, GridSizeX);
+	int32 MaxX = CellCoordinate(Location.X + Radius, GridOrigin.X, GridSizeX);
+	int32 MinY = CellCoordinate(Location.Y - Radius, GridOrigin.Y, GridSizeY);
+	int32 MaxY = CellCoordinate(Location.Y + Radius, GridOrigin.Y, GridSizeY);
+
+	int32 BestIndex = INDEX_NONE;
+	float BestDistanceSquared = Radius * Radius;
+
+	for (int32 Y = MinY; Y <= MaxY; Y++) {
+		for (int32 X = MinX; X <= MaxX; X++) {
+			int32 Cell = Y * GridSizeX + X;
+
+			for (int32 Index = CellStart[Cell]; Index < CellStart[Cell + 1]; Index++) {
+				const FCoverPoint& Point = CoverPoints[Index];
+				FVector PointLocation = Point.GetLocation();
+				float DistanceSquared = FVector::DistSquared(PointLocation, Location);
+
+				if (DistanceSquared >= BestDistanceSquared) {
+					continue;
+				}
+
+				// The cover must stand between the point and the threat
+				if (ThreatLocation) {
+					FVector ToThreat = (*ThreatLocation - PointLocation).GetSafeNormal2D();
+					if (FVector::DotProduct(ToThreat, Point.GetFacing()) < 0.5f) {
+						continue;
+					}
+				}
+
+				BestIndex = Index;
+				BestDistanceSquared = DistanceSquared;
+			}
+		}
+	}
+
+	return BestIndex;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Editor: cover bake
+
+#if WITH_EDITOR
+
+void ACoverIndex::BakeCover() {
+	UWorld* World = GetWorld();
+	if (!World) {
+		return;
+	}
+
+	Modify();
+
+	const FVector Center = GetActorLocation();
+	const FCollisionObjectQueryParams StaticObjects(ECC_WorldStatic);
+
+	TArray<FCoverPoint> Points;
+	// Several floor samples find the same wall, keep one point per half sample and facing octant
+	TSet<FIntVector> Occupied;
+
+	for (float X = -BakeExtent.X; X <= BakeExtent.X; X += SampleSpacing) {
+		for (float Y = -BakeExtent.Y; Y <= BakeExtent.Y; Y += SampleSpacing) {
+			FVector Top = Center + FVector(X, Y, BakeExtent.Z);
+			FVector Bottom = Center + FVector(X, Y, -BakeExtent.Z);
+			FHitResult FloorHit;
+
+			if (!World->LineTraceSingleByObjectType(FloorHit, Top, Bottom, StaticObjects) || FloorHit.ImpactNormal.Z < 0.7f) {
+				continue;
+			}
+
+			for (int32 Octant = 0; Octant < 8; Octant++) {
+				FVector Direction = FRotator(0.0f, Octant * 45.0f, 0.0f).Vector();
+				FCoverPoint Point;
+
+				if (!ProbeCover(FloorHit.ImpactPoint, Direction, Point)) {
+					continue;
+				}
+
+				float KeySize = SampleSpacing * 0.5f;
+				FIntVector Key(FMath::RoundToInt(Point.Location.X / KeySize), FMath::RoundToInt(Point.Location.Y / KeySize), Point.FacingYaw >> 13);
+
+				if (!Occupied.Contains(Key)) {
+					Occupied.Add(Key);
+					Points.Add(Point);
+				}
+			}
+		}
+	}
+
+	// Mark the points where the cover ends on either side
+	for (FCoverPoint& Point : Points) {
+		FVector Floor = Point.GetLocation();
+		FVector Facing = Point.GetFacing();
+		FVector Side = Point.GetTangent() * (SampleSpacing * 0.5f);
+
+		if (!IsCoveredAt(Floor - Side, Facing, LowCoverHeight * 0.5f)) {
+			Point.Flags |= FCoverPoint::FlagLeftEdge;
+		}
+		if (!IsCoveredAt(Floor + Side, Facing, LowCoverHeight * 0.5f)) {
+			Point.Flags |= FCoverPoint::FlagRightEdge;
+		}
+	}
+
+	BuildGrid(Points);
+}
+
+bool ACoverIndex::ProbeCover(const FVector& Floor, const FVector& Direction, FCoverPoint& OutPoint) const {
+	FVector Start = Floor + FVector::UpVector * (LowCoverHeight * 0.5f);
+	FHitResult Hit;
+
+	if (!GetWorld()->LineTraceSingleByObjectType(Hit, Start, Start + Direction * WallProbeDistance, FCollisionObjectQueryParams(ECC_WorldStatic))) {
+		return false;
+	}
+
+	// Only near vertical surfaces are cover
+	if (FMath::Abs(Hit.ImpactNormal.Z) > 0.3f) {
+		return false;
+	}
+
+	FVector Facing = (-Hit.ImpactNormal).GetSafeNormal2D();
+	FVector CoverFloor = FVector(Hit.ImpactPoint.X, Hit.ImpactPoint.Y, Floor.Z) - Facing * WallOffset;
+
+	if (!IsCoveredAt(CoverFloor, Facing, LowCoverHeight)) {
+		return false;
+	}
+
+	// Measure the cover height up to the high cover limit
+	float Height = LowCoverHeight;
+	while (Height < HighCoverHeight && IsCoveredAt(CoverFloor, Facing, Height + 10.0f)) {
+		Height += 10.0f;
+	}
+
+	OutPoint.Location = FVector3f(CoverFloor);
+	OutPoint.FacingYaw = FRotator::CompressAxisToShort(Facing.Rotation().Yaw);
+	OutPoint.Height = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Height / 4.0f), 0, 255));
+	OutPoint.Flags = Height < HighCoverHeight ? FCoverPoint::FlagLowCover : 0;
+	return true;
+}
+
+bool ACoverIndex::IsCoveredAt(const FVector& Floor, const FVector& Facing, float Height) const {
+	FVector Start = Floor + FVector::UpVector * Height;
+	FVector End = Start + Facing * (WallOffset * 2.0f);
+	FHitResult Hit;
+
+	return GetWorld()->LineTraceSingleByObjectType(Hit, Start, End, FCollisionObjectQueryParams(ECC_WorldStatic));
+}
+
+void ACoverIndex::BuildGrid(TArray<FCoverPoint>& Points) {
+	const FVector Center = GetActorLocation();
+
+	BakedCellSize = CellSize;
+	GridOrigin = FVector2f(Center.X - BakeExtent.X, Center.Y - BakeExtent.Y);
+	GridSizeX = FMath::Max(1, FMath::CeilToInt(2.0f * BakeExtent.X / BakedCellSize));
+	GridSizeY = FMath::Max(1, FMath::CeilToInt(2.0f * BakeExtent.Y / BakedCellSize));
+
+	auto CellOf = [this](const FCoverPoint& Point) {
+		return CellCoordinate(Point.Location.Y, GridOrigin.Y, GridSizeY) * GridSizeX + CellCoordinate(Point.Location.X, GridOrigin.X, GridSizeX);
+	};
+
+	Points.Sort([&CellOf](const FCoverPoint& A, const FCoverPoint& B) { return CellOf(A) < CellOf(B); });
+
+	// Count the points of every cell, then turn the counts into start offsets
+	CellStart.Init(0, GridSizeX * GridSizeY + 1);
+	for (const FCoverPoint& Point : Points) {
+		CellStart[CellOf(Point) + 1]++;
+	}
+	for (int32 Cell = 1; Cell < CellStart.Num(); Cell++) {
+		CellStart[Cell] += CellStart[Cell - 1];
+	}
+
+	CoverPoints = MoveTemp(Points);
+}
+
+#endif
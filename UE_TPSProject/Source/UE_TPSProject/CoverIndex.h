@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CoverIndex.generated.h"
+
+/** A baked cover spot, 16 bytes */
+USTRUCT()
+struct FCoverPoint
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	static constexpr uint8 FlagLowCover = 1 << 0;
+	static constexpr uint8 FlagLeftEdge = 1 << 1;
+	static constexpr uint8 FlagRightEdge = 1 << 2;
+
+	/** Floor location where the pawn stands while in cover */
+	UPROPERTY()
+	FVector3f Location = FVector3f::ZeroVector;
+
+	/** Yaw of the direction facing the cover, quantized on 16 bits */
+	UPROPERTY()
+	uint16 FacingYaw = 0;
+
+	/** Cover height in 4 units steps */
+	UPROPERTY()
+	uint8 Height = 0;
+
+	UPROPERTY()
+	uint8 Flags = 0;
+
+	FVector GetLocation() const { return FVector(Location); }
+
+	/** Unit vector pointing from the cover point to the cover */
+	FVector GetFacing() const { return FRotator(0.0f, FRotator::DecompressAxisFromShort(FacingYaw), 0.0f).Vector(); }
+
+	/** Direction the pawn can move along the cover */
+	FVector GetTangent() const { return FVector::CrossProduct(FVector::UpVector, GetFacing()); }
+
+	float GetHeight() const { return Height * 4.0f; }
+
+	bool IsLowCover() const { return (Flags & FlagLowCover) != 0; }
+};
+
+/**
+ * Level-placed index of the cover points baked inside its area.
+ * Points are stored sorted by cell of a uniform 2D grid, so runtime queries only visit
+ * the cells overlapping the search radius and never allocate.
+ */
+UCLASS()
+class UE_TPSPROJECT_API ACoverIndex : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACoverIndex();
+
+	/** Half size of the baked area, centered on the actor. Bake again after moving the actor */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	FVector BakeExtent = FVector(5000.0f, 5000.0f, 1000.0f);
+
+	/** Distance between two floor samples */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float SampleSpacing = 100.0f;
+
+	/** Max distance between a floor sample and the cover */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float WallProbeDistance = 100.0f;
+
+	/** Distance kept between the cover point and the cover, usually the capsule radius */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float WallOffset = 42.0f;
+
+	/** Minimum height of an obstacle to be considered cover */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float LowCoverHeight = 90.0f;
+
+	/** Obstacles blocking at this height are full height cover */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float HighCoverHeight = 170.0f;
+
+	/** Size of a cell of the runtime grid */
+	UPROPERTY(EditAnywhere, Category = "Cover: bake")
+	float CellSize = 500.0f;
+
+	/** Find the cover index of the world, cache the result: this walks the level actors */
+	static ACoverIndex* FindInWorld(const UWorld* World);
+
+	/**
+	 * Find the nearest cover point within Radius.
+	 * @param ThreatLocation	When not null, only cover points facing the threat are considered
+	 * @return The index of the cover point or INDEX_NONE
+	 */
+	int32 FindNearestCover(const FVector& Location, float Radius, const FVector* ThreatLocation = nullptr) const;
+
+	const FCoverPoint& GetCoverPoint(int32 Index) const { return CoverPoints[Index]; }
+
+	int32 NumCoverPoints() const { return CoverPoints.Num(); }
+
+#if WITH_EDITOR
+	/** Sample the level inside BakeExtent and rebuild the cover index */
+	UFUNCTION(CallInEditor, Category = "Cover: bake")
+	void BakeCover();
+#endif
+
+private:
+	/** Cover points, sorted by grid cell */
+	UPROPERTY()
+	TArray<FCoverPoint> CoverPoints;
+
+	/** CellStart[Cell] is the first point of Cell, CellStart[Cell + 1] the end */
+	UPROPERTY()
+	TArray<int32> CellStart;
+
+	UPROPERTY()
+	FVector2f GridOrigin = FVector2f::ZeroVector;
+
+	UPROPERTY()
+	int32 GridSizeX = 0;
+
+	UPROPERTY()
+	int32 GridSizeY = 0;
+
+	UPROPERTY()
+	float BakedCellSize = 500.0f;
+
+	int32 CellCoordinate(float Value, float Origin, int32 GridSize) const;
+
+#if WITH_EDITOR
+	bool ProbeCover(const FVector& Floor, const FVector& Direction, FCoverPoint& OutPoint) const;
+
+	bool IsCoveredAt(const FVector& Floor, const FVector& Facing, float Height) const;
+
+	void BuildGrid(TArray<FCoverPoint>& Points);
+#endif
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CurveDriverComponent.h"
+
+UCurveDriverComponent::UCurveDriverComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Sleep until a track is played
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UCurveDriverComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	bool bAnyPlaying = false;
+
+	for (FCurveTrack& CurveTrack : Tracks) {
+		if (CurveTrack.Direction == 0.0f) {
+			continue;
+		}
+
+		CurveTrack.Position = FMath::Clamp(CurveTrack.Position + DeltaTime * CurveTrack.Direction, 0.0f, CurveTrack.Length);
+		EvaluateTrack(CurveTrack);
+
+		bool bReachedEnd = CurveTrack.Direction > 0.0f ? CurveTrack.Position >= CurveTrack.Length : CurveTrack.Position <= 0.0f;
+		if (bReachedEnd) {
+			CurveTrack.Direction = 0.0f;
+		} else {
+			bAnyPlaying = true;
+		}
+	}
+
+	if (!bAnyPlaying) {
+		SetComponentTickEnabled(false);
+	}
+}
+
+int32 UCurveDriverComponent::AddTrack() {
+	return Tracks.AddDefaulted();
+}
+
+void UCurveDriverComponent::AddFloatCurve(int32 Track, UCurveFloat* Curve, FCurveDriverFloat Callback) {
+	if (!Curve || !Tracks.IsValidIndex(Track)) {
+		return;
+	}
+
+	float MinTime, MaxTime;
+	Curve->GetTimeRange(MinTime, MaxTime);
+	Tracks[Track].Length = FMath::Max(Tracks[Track].Length, MaxTime);
+	Tracks[Track].FloatCurves.Add({Curve, MoveTemp(Callback)});
+	BoundCurves.Add(Curve);
+}
+
+void UCurveDriverComponent::AddVectorCurve(int32 Track, UCurveVector* Curve, FCurveDriverVector Callback) {
+	if (!Curve || !Tracks.IsValidIndex(Track)) {
+		return;
+	}
+
+	float MinTime, MaxTime;
+	Curve->GetTimeRange(MinTime, MaxTime);
+	Tracks[Track].Length = FMath::Max(Tracks[Track].Length, MaxTime);
+	Tracks[Track].VectorCurves.Add({Curve, MoveTemp(Callback)});
+	BoundCurves.Add(Curve);
+}
+
+void UCurveDriverComponent::Play(int32 Track) {
+	StartTrack(Track, 1.0f);
+}
+
+void UCurveDriverComponent::Reverse(int32 Track) {
+	StartTrack(Track, -1.0f);
+}
+
+bool UCurveDriverComponent::IsPlaying(int32 Track) const {
+	return Tracks.IsValidIndex(Track) && Tracks[Track].Direction != 0.0f;
+}
+
+void UCurveDriverComponent::StartTrack(int32 Track, float Direction) {
+	if (!Tracks.IsValidIndex(Track)) {
+		return;
+	}
+
+	FCurveTrack& CurveTrack = Tracks[Track];
+	bool bAlreadyAtEnd = Direction > 0.0f ? CurveTrack.Position >= CurveTrack.Length : CurveTrack.Position <= 0.0f;
+	if (bAlreadyAtEnd) {
+		CurveTrack.Direction = 0.0f;
+		return;
+	}
+
+	CurveTrack.Direction = Direction;
+	SetComponentTickEnabled(true);
+}
+
+void UCurveDriverComponent::EvaluateTrack(const FCurveTrack& CurveTrack) const {
+	for (const FFloatBinding& Binding : CurveTrack.FloatCurves) {
+		Binding.Callback.ExecuteIfBound(Binding.Curve->GetFloatValue(CurveTrack.Position));
+	}
+
+	for (const FVectorBinding& Binding : CurveTrack.VectorCurves) {
+		Binding.Callback.ExecuteIfBound(Binding.Curve->GetVectorValue(CurveTrack.Position));
+	}
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "CurveDriverComponent.generated.h"
+
+DECLARE_DELEGATE_OneParam(FCurveDriverFloat, float);
+DECLARE_DELEGATE_OneParam(FCurveDriverVector, FVector);
+
+/**
+ * Plays float and vector curves forward or backward and hands the values to native callbacks.
+ * Curves are grouped in tracks that share the play position, like the curves of a FTimeline.
+ * The component ticks only while at least one track is playing.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class UE_TPSPROJECT_API UCurveDriverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCurveDriverComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Create an empty track and return its index */
+	int32 AddTrack();
+
+	void AddFloatCurve(int32 Track, UCurveFloat* Curve, FCurveDriverFloat Callback);
+
+	void AddVectorCurve(int32 Track, UCurveVector* Curve, FCurveDriverVector Callback);
+
+	/** Play the track forward from its current position */
+	void Play(int32 Track);
+
+	/** Play the track backward from its current position */
+	void Reverse(int32 Track);
+
+	bool IsPlaying(int32 Track) const;
+
+private:
+	struct FFloatBinding
+	{
+		UCurveFloat* Curve;
+		FCurveDriverFloat Callback;
+	};
+
+	struct FVectorBinding
+	{
+		UCurveVector* Curve;
+		FCurveDriverVector Callback;
+	};
+
+	struct FCurveTrack
+	{
+		float Position = 0.0f;
+		float Length = 0.0f;
+		/** 1 forward, -1 backward, 0 stopped */
+		float Direction = 0.0f;
+		TArray<FFloatBinding> FloatCurves;
+		TArray<FVectorBinding> VectorCurves;
+	};
+
+	TArray<FCurveTrack> Tracks;
+
+	/** Curves are referenced by the owner's properties, this keeps them alive for the bindings */
+	UPROPERTY()
+	TArray<UCurveBase*> BoundCurves;
+
+	void StartTrack(int32 Track, float Direction);
+
+	void EvaluateTrack(const FCurveTrack& CurveTrack) const;
+};
@@ -3,13 +3,28 @@
 
 #include "Enemy.h"
 
+#include "UE_TPSProject.h"
+#include "CombatRecorderSubsystem.h"
+#include "CombatTelemetry.h"
+#include "CollisionReport.h"
+#include "CoverIndex.h"
+#include "EnemyPersistenceSubsystem.h"
+#include "FrameScratch.h"
+#include "GameEventSubsystem.h"
 #include "HealthComponent.h"
+#include "HitboxComponent.h"
+#include "ProjectileSubsystem.h"
+#include "TargetingSubsystem.h"
 #include "UE_TPSProjectCharacter.h"
+#include "IAnimationBudgetAllocator.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
 
 // Sets default values
-AEnemy::AEnemy()
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -21,12 +36,31 @@ AEnemy::AEnemy()
 	GetCharacterMovement()->SetCrouchedHalfHeight(52.0f);
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 0.0f, 250.0f);
 
+	// Let the animation budget allocator throttle the mesh, significance is computed by UpdateAnimationSignificance
+	USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh());
+	if (BudgetedMesh) {
+		BudgetedMesh->SetAutoRegisterWithBudgetAllocator(true);
+		BudgetedMesh->SetAutoCalculateSignificance(false);
+		BudgetedMesh->bEnableUpdateRateOptimizations = true;
+	}
+
 	// Add a mesh for the weapon
 	WeaponMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("WeaponMesh"));
 	WeaponMesh->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform, "hand_rSocket");
+	// No physics state, the weapon follows the hand bone every frame without touching the physics scene
+	WeaponMesh->SetCollisionProfileName(COLLISION_PROFILE_WEAPON_MESH);
+	WeaponMesh->SetGenerateOverlapEvents(false);
 	
 	// Add Health manager
 	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("Health Component"));
+
+	// Shots stop on the capsule and are resolved on the hitbox proxies, the mesh has no bodies at all
+	Hitbox = CreateDefaultSubobject<UHitboxComponent>(TEXT("Hitbox"));
+	GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_CHARACTER);
+	GetMesh()->SetCollisionProfileName(COLLISION_PROFILE_CHARACTER_MESH);
+
+	// Add the aim and crouch transitions driver
+	CurveDriver = CreateDefaultSubobject<UCurveDriverComponent>(TEXT("Curve Driver"));
 }
 
 
@@ -34,7 +68,56 @@ AEnemy::AEnemy()
 // UE4 functions for game thread
 
 void AEnemy::BeginPlay() {
-	Super::BeginPlay();	
+	Super::BeginPlay();
+
+	if (AimCurve) {
+		AimTrack = CurveDriver->AddTrack();
+		CurveDriver->AddFloatCurve(AimTrack, AimCurve, FCurveDriverFloat::CreateUObject(this, &AEnemy::HandleProgressAim));
+	}
+
+	if (CrouchCurve) {
+		CrouchTrack = CurveDriver->AddTrack();
+		CurveDriver->AddFloatCurve(CrouchTrack, CrouchCurve, FCurveDriverFloat::CreateUObject(this, &AEnemy::HandleProgressCrouch));
+	}
+
+	CoverIndex = ACoverIndex::FindInWorld(GetWorld());
+
+	// Spread the updates so enemies placed together don't refresh on the same frame
+	GetWorldTimerManager().SetTimer(AnimationSignificanceTimer, this, &AEnemy::UpdateAnimationSignificance,
+		AnimationSignificanceInterval, true, FMath::FRandRange(0.0f, AnimationSignificanceInterval));
+
+	// Streamed back in: restore the stored state once the controller has started its behaviour tree
+	GetWorldTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]() {
+		if (UEnemyPersistenceSubsystem* Persistence = GetWorld()->GetSubsystem<UEnemyPersistenceSubsystem>()) {
+			Persistence->RestoreEnemy(this);
+		}
+	}));
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	// The cell or level of the enemy is streaming out
+	if (EndPlayReason == EEndPlayReason::RemovedFromWorld) {
+		if (UEnemyPersistenceSubsystem* Persistence = GetWorld()->GetSubsystem<UEnemyPersistenceSubsystem>()) {
+			Persistence->StoreEnemy(this);
+		}
+
+		// The controller lives in the persistent level, a new one is spawned when the enemy comes back
+		DetachFromControllerPendingDestroy();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemy::Revive() {
+	// The dead controller zeroed the speed, the class default holds the authored one
+	GetCharacterMovement()->MaxWalkSpeed = GetClass()->GetDefaultObject<AEnemy>()->GetCharacterMovement()->MaxWalkSpeed;
+	GetCharacterMovement()->SetDefaultMovementMode();
+	GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_CHARACTER);
+
+	// The controller destroyed itself on death
+	if (!GetController()) {
+		SpawnDefaultController();
+	}
 }
 
 void AEnemy::Tick(float DeltaTime) {
@@ -50,6 +133,8 @@ void AEnemy::OnConstruction(const FTransform & Transform) {
 // Mechanic: Fire with weapon
 
 void AEnemy::FireWithSphereSweep() {
+	SCOPE_HOT_PATH(Fire);
+
 	FCollisionQueryParams Params;
 	// Ignore the enemy's pawn
 	AActor* Myself = Cast<AActor>(this);
@@ -65,33 +150,109 @@ void AEnemy::FireWithSphereSweep() {
 	FVector Start = WeaponMesh->GetComponentLocation()+ ZForward + (WeaponMesh->GetForwardVector() * WeaponOffset);
 	FVector End = Start + (GetActorForwardVector() * WeaponRange);
 
+	UCombatRecorderSubsystem::RecordEvent(this, ECombatRecordEvent::Fire, this);
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::Shot, this);
+
+	if (WeaponSlot.FireMode == EWeaponFireMode::Projectile) {
+		if (UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>()) {
+			Projectiles->FireProjectile(this, Start, GetActorForwardVector(), WeaponSlot);
+		}
+		return;
+	}
+
 	FHitResult Hit;
+	bool bHit = false;
+	float PlayerDistance;
 
-	bool bHit = GetWorld()->SweepSingleByChannel(Hit, Start, End, FQuat::Identity, ECC_Pawn, CollShape, Params);
-	OnCharacterTraceLine.Broadcast();
+	// Most shots miss: test the player capsules analytically and sweep only to confirm the occlusion
+	{
+		SCOPE_COLLISION_QUERY(this);
+		if (ProbePlayers(Start, End, WeaponRadius, PlayerDistance)) {
+			FVector ConfirmEnd = Start + GetActorForwardVector() * PlayerDistance;
+			bHit = GetWorld()->SweepSingleByChannel(Hit, Start, ConfirmEnd, FQuat::Identity, ECC_Weapon, CollShape, Params);
+		} else if (ShouldPlayCosmetics(GetWorld())) {
+			// Nobody in the line of fire, the impact is only cosmetic
+			bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Weapon, Params);
+		}
+	}
+	UGameEventSubsystem::Post(this, EGameEvent::TraceLine);
 
 	if (bHit) {
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), WeaponSlot.HitEFX, Hit.ImpactPoint);
+		const bool bCosmetics = ShouldPlayCosmetics(GetWorld());
+		if (bCosmetics) {
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), WeaponSlot.HitEFX, Hit.ImpactPoint);
+		}
 		AUE_TPSProjectCharacter* HitPlayer = Cast<AUE_TPSProjectCharacter>(Hit.GetActor()); // Maybe here is broken due to new engine version
 
 		if (HitPlayer) {
-			GEngine->AddOnScreenDebugMessage(-1, 4.0f, FColor::Green, TEXT("Hit! Player"));
-			HitPlayer->GetHealthComponent()->GetDamage(WeaponSlot.Damage);
-		} else {
+			if (bCosmetics) {
+				GEngine->AddOnScreenDebugMessage(-1, 4.0f, FColor::Green, TEXT("Hit! Player"));
+			}
+			float Damage = UHitboxComponent::ComputeDamage(HitPlayer, WeaponSlot.Damage, WeaponSlot.ZoneDamage, Start, GetActorForwardVector(), WeaponRadius);
+			if (Damage > 0.0f) {
+				FCombatTelemetry::Record(CombatTelemetry::ERecordType::Hit, this, HitPlayer);
+				HitPlayer->GetHealthComponent()->GetDamage(Damage);
+			}
+		} else if (bCosmetics) {
 			GEngine->AddOnScreenDebugMessage(-1, 4.0f, FColor::Green, TEXT("Hit! " + Hit.GetActor()->GetName()));
 		}		
 	}
 }
 
+bool AEnemy::ProbePlayers(const FVector& Start, const FVector& End, float Radius, float& HitDistance) const {
+	const float Range = FVector::Dist(Start, End);
+	bool bFound = false;
+	HitDistance = Range;
+
+	UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>();
+	if (!Targeting) {
+		return false;
+	}
+
+	// Bots have no player controller, the registered characters cover both
+	for (const TWeakObjectPtr<AUE_TPSProjectCharacter>& PlayerPtr : Targeting->GetPlayers()) {
+		const ACharacter* Player = PlayerPtr.Get();
+		if (!Player) {
+			continue;
+		}
+
+		// Closest points between the shot and the capsule axis, the sphere touches if they are within both radii
+		const UCapsuleComponent* Capsule = Player->GetCapsuleComponent();
+		FVector Center = Capsule->GetComponentLocation();
+		FVector Axis = Capsule->GetUpVector() * Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+		float Reach = Capsule->GetScaledCapsuleRadius() + Radius;
+
+		FVector OnShot;
+		FVector OnAxis;
+		FMath::SegmentDistToSegmentSafe(Start, End, Center - Axis, Center + Axis, OnShot, OnAxis);
+		if (FVector::DistSquared(OnShot, OnAxis) > FMath::Square(Reach)) {
+			continue;
+		}
+
+		// The confirmation sweep stops just past the nearest capsule
+		HitDistance = FMath::Min(HitDistance, FVector::Dist(Start, OnShot) + Reach);
+		bFound = true;
+	}
+	return bFound;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Mechanic: Aim
 
 void AEnemy::AimIn() {
+	bIsAiming = true;
+	CurveDriver->Play(AimTrack);
+	UpdateAnimationSignificance();
+	UGameEventSubsystem::Post(this, EGameEvent::Aim);
 	OnCharacterAim.Broadcast();
 	OnEnemyAim();
 }
 
 void AEnemy::AimOut() {
+	bIsAiming = false;
+	CurveDriver->Reverse(AimTrack);
+	UpdateAnimationSignificance();
+	UGameEventSubsystem::Post(this, EGameEvent::StopAim);
 	OnCharacterStopAim.Broadcast();
 }
 
@@ -101,14 +262,89 @@ void AEnemy::AimOut() {
 void AEnemy::CrouchMe() {
 	if (CanCrouch()) {
 		Crouch();
+		CurveDriver->Play(CrouchTrack);
+		UGameEventSubsystem::Post(this, EGameEvent::Crouch);
 		OnCharacterCrouch.Broadcast();
 	}
 }
 
+bool AEnemy::FindCover(FVector ThreatLocation, float SearchRadius, FVector& CoverLocation) {
+	if (!CoverIndex) {
+		return false;
+	}
+
+	int32 Cover = CoverIndex->FindNearestCover(GetActorLocation(), SearchRadius, &ThreatLocation);
+	if (Cover == INDEX_NONE) {
+		return false;
+	}
+
+	CoverLocation = CoverIndex->GetCoverPoint(Cover).GetLocation();
+	return true;
+}
+
 void AEnemy::UncrouchMe() {
 	GEngine->AddOnScreenDebugMessage(-1, 5.2f, FColor::Orange, TEXT("Enemy uncrouch!"));
 	UnCrouch();
+	CurveDriver->Reverse(CrouchTrack);
+	UGameEventSubsystem::Post(this, EGameEvent::Uncrouch);
 	OnCharacterUncrouch.Broadcast();
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Curve management
+
+void AEnemy::HandleProgressAim(float Value) {
+	AimAlpha = Value;
+}
+
+void AEnemy::HandleProgressCrouch(float Value) {
+	CrouchAlpha = Value;
+}
 
+//////////////////////////////////////////////////////////////////////////
+// Animation budget
+
+void AEnemy::UpdateAnimationSignificance() {
+	USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh());
+	IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld());
+
+	if (!BudgetedMesh || !Allocator) {
+		return;
+	}
+
+	// Nearest view of any player: every local split screen view, or every client on a server
+	const FVector Location = GetActorLocation();
+	double NearestSquared = TNumericLimits<double>::Max();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		if (APlayerController* PlayerController = It->Get()) {
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(ViewLocation, Location));
+		}
+	}
+
+	// Without any player controller, the registered players and bots stand for the views
+	if (NearestSquared == TNumericLimits<double>::Max()) {
+		if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+			for (const TWeakObjectPtr<AUE_TPSProjectCharacter>& Player : Targeting->GetPlayers()) {
+				if (Player.IsValid()) {
+					NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(Player->GetActorLocation(), Location));
+				}
+			}
+		}
+	}
+
+	if (NearestSquared == TNumericLimits<double>::Max()) {
+		return;
+	}
+
+	float Distance = FMath::Sqrt(NearestSquared);
+	float Significance = 1.0f - FMath::Clamp(Distance / AnimationSignificanceDistance, 0.0f, 1.0f);
+
+	// An aiming enemy keeps a full rate pose: FireWithSphereSweep starts from the weapon socket. A dedicated
+	// server renders nothing, its enemies must tick unrendered for the sweeps and the hitbox proxies
+	bool bTickEvenIfNotRendered = bIsAiming || GetNetMode() == NM_DedicatedServer;
+	Allocator->SetComponentSignificance(BudgetedMesh, Significance, bIsAiming, bTickEvenIfNotRendered, !bIsAiming);
+}
@@ -6,8 +6,12 @@
 #include "GameFramework/Character.h"
 #include "FWeaponSlot.h"
 #include "EnemyPath.h"
+#include "CurveDriverComponent.h"
 #include "Enemy.generated.h"
 
+class ACoverIndex;
+class UHitboxComponent;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FGameStateEnemy);
 UCLASS()
 class UE_TPSPROJECT_API AEnemy : public ACharacter
@@ -16,7 +20,7 @@ class UE_TPSPROJECT_API AEnemy : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
 	float AimOffset = 60.0f;
@@ -30,9 +34,39 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Health", meta = (AllowPrivateAccess = "true"))
 	UHealthComponent* HealthComponent;
 
+	/** Body part capsules resolving where the shots hit */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Health", meta = (AllowPrivateAccess = "true"))
+	UHitboxComponent* Hitbox;
+
+	/** Drives the aim and crouch transitions, sleeps when no transition is playing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Timeline", meta = (AllowPrivateAccess = "true"))
+	UCurveDriverComponent* CurveDriver;
+
+	UPROPERTY(EditAnywhere, Category = "Timeline")
+	UCurveFloat* AimCurve;
+
+	UPROPERTY(EditAnywhere, Category = "Timeline")
+	UCurveFloat* CrouchCurve;
+
+	/** Aim transition value driven by AimCurve, read by the animation blueprint */
+	UPROPERTY(BlueprintReadOnly, Category = "Timeline")
+	float AimAlpha = 0.0f;
+
+	/** Crouch transition value driven by CrouchCurve, read by the animation blueprint */
+	UPROPERTY(BlueprintReadOnly, Category = "Timeline")
+	float CrouchAlpha = 0.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path")
 	AEnemyPath* PathToPatrol;
 
+	/** Distance from the viewer at which the animation significance reaches zero */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Animation")
+	float AnimationSignificanceDistance = 6000.0f;
+
+	/** Seconds between two significance updates sent to the animation budget allocator */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Animation")
+	float AnimationSignificanceInterval = 0.25f;
+
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnEnemyAim();
 	
@@ -41,8 +75,37 @@ protected:
 	
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+private:
+	bool bIsAiming = false;
+
+	FTimerHandle AnimationSignificanceTimer;
+
+	/** Baked cover points of the level, null if the level has none */
+	UPROPERTY(Transient)
+	ACoverIndex* CoverIndex;
+
+	int32 AimTrack = INDEX_NONE;
+
+	int32 CrouchTrack = INDEX_NONE;
+
+	void HandleProgressAim(float Value);
+
+	void HandleProgressCrouch(float Value);
+
+	/** Push the mesh significance to the animation budget allocator */
+	void UpdateAnimationSignificance();
+
+	/**
+	 * Analytic test of the shot Start-End, swept by a sphere of Radius, against the player capsules.
+	 * @param HitDistance Distance along the shot to sweep to confirm the nearest hit
+	 * @return False if no player is in the line of fire
+	 */
+	bool ProbePlayers(const FVector& Start, const FVector& End, float Radius, float& HitDistance) const;
+
 public:
 	virtual void Tick(float DeltaTime) override;
 	
@@ -55,12 +118,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Cover")
 	void UncrouchMe();
 
+	/**
+	 * Find the nearest baked cover point protecting from ThreatLocation.
+	 * @return False if no cover is available within SearchRadius
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Cover")
+	bool FindCover(FVector ThreatLocation, float SearchRadius, FVector& CoverLocation);
+
 	UFUNCTION(BlueprintCallable, Category = "Cover")
 	void AimIn();
 
 	UFUNCTION(BlueprintCallable, Category = "Cover")
 	void AimOut();
 
+	bool IsAiming() const { return bIsAiming; }
+
+	/** Undo the death applied by the controller: capsule and movement back, a new controller runs the behaviour tree */
+	void Revive();
+
 	/** Broadcasted when character land on ground */
 	UPROPERTY(BlueprintAssignable)
 	FGameStateEnemy OnCharacterLanding;
@@ -85,13 +160,6 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FGameStateEnemy OnCharacterStopAim;
 
-	/** Broadcsted when character reloading the weapon */
-	UPROPERTY(BlueprintAssignable)
-	FGameStateEnemy OnCharacterStartReload;
-
-	/** Broadcsted when character trace line from weapon */
-	UPROPERTY(BlueprintAssignable)
-	FGameStateEnemy OnCharacterTraceLine;
 	
 	UFUNCTION(BlueprintCallable, Category = "Health")
 	FORCEINLINE class UHealthComponent* GetHealthComponent() const { return HealthComponent; }
@@ -2,10 +2,16 @@
 
 
 #include "EnemyAIController.h"
+#include "UE_TPSProject.h"
+#include "CombatRecorderSubsystem.h"
+#include "CombatTelemetry.h"
 #include "Enemy.h"
+#include "FrameScratch.h"
+#include "GameEventSubsystem.h"
+#include "SquadSubsystem.h"
+#include "TargetingSubsystem.h"
 #include "BrainComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "EngineUtils.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Perception/AIPerceptionComponent.h"
@@ -47,33 +53,82 @@ void AEnemyAIController::BeginPlay() {
 	AEnemy* ControlledPawn = dynamic_cast<AEnemy*>(GetPawn());
 	
 	if (IsValid(ControlledPawn)) {
-		ControlledPawn->HealthComponent->OnHealtToZero.AddDynamic(this, &AEnemyAIController::StopAI);
-		// Detect player if hit by gun
-		ControlledPawn->HealthComponent->OnGetDamage.AddDynamic(this, &AEnemyAIController::DetectPlayer);
+		if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+			Events->Subscribe(EGameEvent::HealthZero, this, ControlledPawn, FGameEventDelegate::CreateWeakLambda(this, [this](const FGameEvent&) {
+				StopAI();
+			}));
+			// Detect player if hit by gun
+			Events->Subscribe(EGameEvent::Damaged, this, ControlledPawn, FGameEventDelegate::CreateWeakLambda(this, [this](const FGameEvent&) {
+				DetectPlayer();
+			}));
+		}
 		// Set the character's walk speed
 		GetBlackboardComponent()->SetValueAsFloat("OriginalWalkSpeed", ControlledPawn->GetCharacterMovement()->MaxWalkSpeed);
 	}
 
 	// Add OnPerceptionUpdate_SenseManagement to the UE4's perception component
 	PerceptionComponent->OnPerceptionUpdated.AddDynamic(this, &AEnemyAIController::OnPerceptionUpdate_SenseManagement);
+
+	// Engage positions are chosen by the squad, read from "SquadPosition" in the blackboard
+	if (USquadSubsystem* Squads = GetWorld()->GetSubsystem<USquadSubsystem>()) {
+		Squads->RegisterMember(this, SquadId);
+	}
+
+	// Targets and threat are scored for all the controllers at once, read from the blackboard
+	if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+		Targeting->RegisterController(this);
+	}
 }
 
+void AEnemyAIController::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	// Also reached when the pawn streams out and the controller is released
+	if (USquadSubsystem* Squads = GetWorld()->GetSubsystem<USquadSubsystem>()) {
+		Squads->UnregisterMember(this);
+	}
+	if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+		Targeting->UnregisterController(this);
+	}
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Unsubscribe(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
 void AEnemyAIController::StopAI() {
 	BrainComponent->StopLogic("Death");
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::Death, nullptr, GetPawn());
+
+	if (USquadSubsystem* Squads = GetWorld()->GetSubsystem<USquadSubsystem>()) {
+		Squads->UnregisterMember(this);
+	}
+	if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+		Targeting->UnregisterController(this);
+	}
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Unsubscribe(this);
+	}
 	AEnemy* ControlledPawn = dynamic_cast<AEnemy*>(GetPawn());
 	
 	if (IsValid(ControlledPawn)) {		
 		ControlledPawn->GetCharacterMovement()->MaxWalkSpeed = 0.0f;
-		ControlledPawn->HealthComponent->OnHealtToZero.RemoveDynamic(this, &AEnemyAIController::StopAI);
-		ControlledPawn->HealthComponent->OnGetDamage.RemoveDynamic(this, &AEnemyAIController::DetectPlayer);
-		ControlledPawn->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		ControlledPawn->WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		// Without collision a moving capsule would fall through the floor
+		ControlledPawn->GetCharacterMovement()->DisableMovement();
+		ControlledPawn->GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_CORPSE);
 	}
 	Destroy();
 }
 
 void AEnemyAIController::DetectPlayer() {
+	SCOPE_HOT_PATH(Alert);
+
+	LastAlertTime = GetWorld()->GetTimeSeconds();
+	UCombatRecorderSubsystem::RecordEvent(this, ECombatRecordEvent::Alert, GetPawn());
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::Alert, GetPawn());
+	ApplyAlert();
+}
+
+void AEnemyAIController::ApplyAlert() {
 	GetBlackboardComponent()->SetValueAsBool("SeePlayer", true);
 	AEnemy* ControlledPawn = dynamic_cast<AEnemy*>(GetPawn());
 
@@ -88,7 +143,27 @@ void AEnemyAIController::DetectPlayer() {
 	GetBlackboardComponent()->SetValueAsObject("Player", PlayerCharacter);
 }
 
+bool AEnemyAIController::IsAlerted() const {
+	const UBlackboardComponent* Blackboard = GetBlackboardComponent();
+	return Blackboard && Blackboard->GetValueAsBool("SeePlayer");
+}
+
+void AEnemyAIController::SetTarget(AUE_TPSProjectCharacter* Player) {
+	PlayerCharacter = Player;
+	GetBlackboardComponent()->SetValueAsObject("Player", PlayerCharacter);
+}
+
+void AEnemyAIController::RestoreAlert(AUE_TPSProjectCharacter* Player, float AlertAge) {
+	PlayerCharacter = Player;
+	ApplyAlert();
+
+	// The alert keeps its age, so it still expires on time if the enemy streams out again
+	LastAlertTime = GetWorld()->GetTimeSeconds() - AlertAge;
+}
+
 void AEnemyAIController::OnPerceptionUpdate_SenseManagement(const TArray<AActor*>& UpdateActors) {
+	SCOPE_HOT_PATH(Alert);
+
 	for (auto& Actor : UpdateActors) {
 		PlayerCharacter = dynamic_cast<AUE_TPSProjectCharacter*>(Actor);
 		
@@ -128,9 +203,19 @@ void AEnemyAIController::ManageHearing(){
 }
 
 void AEnemyAIController::NotifyTeammate() {
+	UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>();
+	if (!Targeting) {
+		return;
+	}
+
+	// The registered controllers, an actor iterator would gather every controller of the world in a new array
 	FVector MyLocation = GetPawn()->GetActorLocation();
-	for (TActorIterator<AEnemyAIController> It(GetWorld()); It; ++It) {
-		AEnemyAIController* Teammate = *It;
+	for (const TWeakObjectPtr<AEnemyAIController>& TeammatePtr : Targeting->GetControllers()) {
+		AEnemyAIController* Teammate = TeammatePtr.Get();
+		if (!Teammate || !Teammate->GetPawn()) {
+			continue;
+		}
+
 		FVector TeammateLocation = Teammate->GetPawn()->GetActorLocation();
 		if (FVector::Distance(MyLocation, TeammateLocation) < TeammateAdviseRadius) { // Advise teammate in a certain radius
 			Teammate->DetectPlayer(); // In this case teammate automatically detect player
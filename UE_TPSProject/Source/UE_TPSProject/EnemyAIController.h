@@ -21,6 +21,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI: Team")
 	float TeammateAdviseRadius = 10000.f;
 
+	/** Members of the same squad share the engage positions planned by USquadSubsystem */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI: Team")
+	int32 SquadId = 0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI: behaviour tree")
 	UBehaviorTree* BehaviourTree;
 
@@ -35,8 +39,21 @@ public:
 	UFUNCTION()
 	void DetectPlayer();
 
+	/** True once the player has been detected */
+	bool IsAlerted() const;
+
+	/** World time of the last player detection, negative if never detected */
+	float GetLastAlertTime() const { return LastAlertTime; }
+
+	/** Target of an alerted controller, the character it detected and its "Player" blackboard key */
+	void SetTarget(AUE_TPSProjectCharacter* Player);
+
+	/** Put back an alert AlertAge seconds old, read from a save or a streamed out enemy. Not a new detection */
+	void RestoreAlert(AUE_TPSProjectCharacter* Player, float AlertAge);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** This function handle all the senses.
 	* Here are implemented all the function call to the ManageSense private functions
@@ -48,6 +65,10 @@ private:
 	UAISenseConfig_Sight* SightConfig;
 	UAISenseConfig_Hearing* HearingConfig;
 	AUE_TPSProjectCharacter* PlayerCharacter;
+	float LastAlertTime = -1.0f;
+
+	/** Alerted state shared by a detection and a restored alert: blackboard, speed and target */
+	void ApplyAlert();
 
 	/** Function used to manege the sight sense*/
 	void ManageSight();
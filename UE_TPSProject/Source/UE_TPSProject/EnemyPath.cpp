@@ -13,8 +13,7 @@ PrimaryActorTick.bCanEverTick = true;
 void AEnemyPath::BeginPlay() {
 	Super::BeginPlay();
 	
-	PathSense = 1;
-	PathIndex = 0;
+	Cursor = GameplayCore::FPatrolCursor();
 }
 
 void AEnemyPath::Tick(float DeltaTime) {
@@ -32,14 +31,16 @@ void AEnemyPath::OnConstruction(const FTransform & Transform) {
 }
 
 void AEnemyPath::GoNextNode() {
-	PathIndex += PathSense;
-	if (PathIndex == PathPoints.Num()-1 || PathIndex == 0) {
-		PathSense *= -1;
-	}
+	GameplayCore::StepPatrol(Cursor, PathPoints.Num());
+}
+
+void AEnemyPath::RestoreCursor(int InPathIndex, int InPathSense) {
+	Cursor.Index = FMath::Clamp(InPathIndex, 0, PathPoints.Num() - 1);
+	Cursor.Sense = InPathSense < 0 ? -1 : 1;
 }
 
 FVector AEnemyPath::ActualPoint() {
-	FVector Pos = GetActorTransform().TransformPosition(PathPoints[PathIndex]);
+	FVector Pos = GetActorTransform().TransformPosition(PathPoints[Cursor.Index]);
 	return Pos;
 }
 
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GameplayCore.h"
 #include "EnemyPath.generated.h"
 
 UCLASS()
@@ -19,10 +20,8 @@ public:
 	TArray<FVector> PathPoints;
 
 private:
-	/** Path sense orientation, am I backtracking the path? */
-	int PathSense;
-	/** An integer representing the path index */
-	int PathIndex;
+	/** Index of the actual point and path sense orientation, am I backtracking the path? */
+	GameplayCore::FPatrolCursor Cursor;
 
 protected:
 
@@ -39,4 +38,9 @@ public:
 	/** Retrieve actual point */
 	UFUNCTION(BlueprintCallable, Category = "AI Path")
 	FVector ActualPoint();
+
+	// Patrol cursor, stored in mission saves
+	int GetPathIndex() const { return Cursor.Index; }
+	int GetPathSense() const { return Cursor.Sense; }
+	void RestoreCursor(int InPathIndex, int InPathSense);
 };
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EnemyPersistenceSubsystem.h"
+
+#include "Enemy.h"
+#include "EnemyAIController.h"
+#include "EnemyPath.h"
+#include "HealthComponent.h"
+#include "UE_TPSProjectCharacter.h"
+#include "Kismet/GameplayStatics.h"
+
+uint32 UEnemyPersistenceSubsystem::EnemyId(const AEnemy* Enemy) {
+	// Paths of placed actors are stable between two loads of their cell, without the PIE prefix of the editor
+	return FCrc::StrCrc32(*UWorld::RemovePIEPrefix(Enemy->GetPathName()));
+}
+
+void UEnemyPersistenceSubsystem::StoreEnemy(AEnemy* Enemy) {
+	const UHealthComponent* Health = Enemy->GetHealthComponent();
+	const AEnemyAIController* Controller = Cast<AEnemyAIController>(Enemy->GetController());
+	const AEnemyPath* Path = Enemy->PathToPatrol;
+
+	FEnemyRecord Record;
+	Record.Health = Health->Health;
+	Record.UnloadTime = GetWorld()->GetTimeSeconds();
+	Record.AlertAge = Controller && Controller->GetLastAlertTime() >= 0.0f ? Record.UnloadTime - Controller->GetLastAlertTime() : 0.0f;
+	Record.PathIndex = IsValid(Path) ? static_cast<int16>(Path->GetPathIndex()) : 0;
+	Record.PathSense = IsValid(Path) ? static_cast<int8>(Path->GetPathSense()) : 1;
+	Record.Flags = 0;
+	if (Health->Health <= 0) {
+		Record.Flags |= RecordDead;
+	}
+	if (Controller && Controller->IsAlerted()) {
+		Record.Flags |= RecordAlerted;
+	}
+
+	// An untouched enemy streams back in its placed state, no record needed
+	bool bInitialState = Record.Flags == 0 && Health->Health >= Health->GetMaxHealth() && Record.PathIndex == 0 && Record.PathSense > 0;
+	if (bInitialState) {
+		Records.Remove(EnemyId(Enemy));
+	} else {
+		Records.Add(EnemyId(Enemy), Record);
+	}
+}
+
+void UEnemyPersistenceSubsystem::RestoreEnemy(AEnemy* Enemy) {
+	FEnemyRecord Record;
+	if (!Records.RemoveAndCopyValue(EnemyId(Enemy), Record)) {
+		return;
+	}
+
+	UHealthComponent* Health = Enemy->GetHealthComponent();
+	AEnemyAIController* Controller = Cast<AEnemyAIController>(Enemy->GetController());
+	AEnemyPath* Path = Enemy->PathToPatrol;
+
+	float Unloaded = bSimulateUnloaded ? GetWorld()->GetTimeSeconds() - Record.UnloadTime : 0.0f;
+	bool bDead = (Record.Flags & RecordDead) != 0;
+	float AlertAge = Record.AlertAge + Unloaded;
+	bool bAlerted = (Record.Flags & RecordAlerted) && (!bSimulateUnloaded || AlertAge < AlertMemory);
+
+	if (IsValid(Path) && !bDead) {
+		Path->RestoreCursor(Record.PathIndex, Record.PathSense);
+
+		// A patrol is periodic, only the steps of the last round trip matter
+		int32 Period = FMath::Max(2 * (Path->PathPoints.Num() - 1), 1);
+		int32 Steps = bAlerted ? 0 : FMath::FloorToInt(Unloaded / PatrolStepTime) % Period;
+		for (int32 Step = 0; Step < Steps; Step++) {
+			Path->GoNextNode();
+		}
+	}
+
+	if (Controller && bAlerted && !bDead) {
+		Controller->RestoreAlert(Cast<AUE_TPSProjectCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0)), AlertAge);
+	}
+
+	float Recovered = 0.0f;
+	if (Health->bAutoRecovery && !bDead) {
+		float RecoveryTime = FMath::Max(Unloaded - Health->NoDamageTimeForRecovery, 0.0f);
+		Recovered = FMath::FloorToFloat(RecoveryTime / FMath::Max(Health->HealthRecoveryTime, KINDA_SMALL_NUMBER)) * Health->RecoveryQuantity;
+	}
+
+	// Last, a dead enemy runs its death logic from the HealthZero event
+	Health->RestoreHealth(bDead ? 0.0f : Record.Health + Recovered, Health->GetMaxHealth());
+}
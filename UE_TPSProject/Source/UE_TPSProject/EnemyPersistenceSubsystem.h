@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPersistenceSubsystem.generated.h"
+
+class AEnemy;
+
+/**
+ * Keeps the state of placed enemies while their World Partition cell or streaming level is unloaded.
+ * An enemy leaving the world stores a 16 byte record, the record is consumed when the enemy streams
+ * back in. Enemies in their initial state store nothing, so the memory grows with the enemies the
+ * player interacted with, not with the size of the map.
+ * While unloaded an enemy is simulated coarsely on restore: health recovery, alert memory and
+ * patrol progress are advanced by the time spent unloaded.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UEnemyPersistenceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Advance the enemies by the time spent unloaded */
+	bool bSimulateUnloaded = true;
+
+	/** Seconds an unloaded enemy stays alerted */
+	float AlertMemory = 30.0f;
+
+	/** Estimated seconds to walk from one patrol point to the next */
+	float PatrolStepTime = 5.0f;
+
+	/** Store the state of an enemy leaving the world */
+	void StoreEnemy(AEnemy* Enemy);
+
+	/** Put back the state stored when the enemy left the world, if any */
+	void RestoreEnemy(AEnemy* Enemy);
+
+	int32 NumStoredEnemies() const { return Records.Num(); }
+
+private:
+	enum ERecordFlags : uint8
+	{
+		RecordDead = 1 << 0,
+		RecordAlerted = 1 << 1
+	};
+
+	struct FEnemyRecord
+	{
+		float Health;
+		/** World time the enemy was unloaded */
+		float UnloadTime;
+		/** Seconds between the last alert and the unload */
+		float AlertAge;
+		int16 PathIndex;
+		int8 PathSense;
+		uint8 Flags;
+	};
+
+	static_assert(sizeof(FEnemyRecord) == 16, "Keep the enemy record compact");
+
+	/** Records of the unloaded enemies, by hash of the actor path */
+	TMap<uint32, FEnemyRecord> Records;
+
+	/** Hash of the level package and actor name, the same name can be placed in two streaming levels */
+	static uint32 EnemyId(const AEnemy* Enemy);
+};
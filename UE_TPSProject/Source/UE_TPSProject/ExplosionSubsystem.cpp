@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ExplosionSubsystem.h"
+
+#include "UE_TPSProject.h"
+#include "CollisionReport.h"
+#include "HealthComponent.h"
+#include "PropHealthSubsystem.h"
+#include "ThrowableActor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+void UExplosionSubsystem::RegisterDamageable(UHealthComponent* Health) {
+	Damageables.AddUnique(Health);
+	GridFrame = MAX_uint64;
+}
+
+void UExplosionSubsystem::UnregisterDamageable(UHealthComponent* Health) {
+	Damageables.RemoveSwap(Health);
+	GridFrame = MAX_uint64;
+}
+
+AThrowableActor* UExplosionSubsystem::AcquireThrowable() {
+	while (FreeThrowables.Num() > 0) {
+		AThrowableActor* Throwable = FreeThrowables.Pop(false);
+		if (IsValid(Throwable)) {
+			return Throwable;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AThrowableActor>(AThrowableActor::StaticClass(), FTransform::Identity, SpawnParams);
+}
+
+void UExplosionSubsystem::ReleaseThrowable(AThrowableActor* Throwable) {
+	Throwable->Deactivate();
+	FreeThrowables.Add(Throwable);
+}
+
+FIntPoint UExplosionSubsystem::CellOf(const FVector& Location) const {
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UExplosionSubsystem::RebuildGridIfStale() {
+	if (GridFrame == GFrameCounter) {
+		return;
+	}
+	GridFrame = GFrameCounter;
+
+	for (auto& Pair : Grid) {
+		Pair.Value.Reset();
+	}
+
+	for (int32 Index = 0; Index < Damageables.Num(); Index++) {
+		UHealthComponent* Health = Damageables[Index].Get();
+		if (Health && Health->GetOwner()) {
+			Grid.FindOrAdd(CellOf(Health->GetOwner()->GetActorLocation())).Add(Index);
+		}
+	}
+}
+
+void UExplosionSubsystem::PlayEffects(const FVector& Location, const FThrowableSlot& Slot) {
+	UWorld* World = GetWorld();
+
+	if (ShouldPlayCosmetics(World)) {
+		UGameplayStatics::SpawnEmitterAtLocation(World, Slot.ExplosionEFX, Location);
+		UGameplayStatics::PlaySoundAtLocation(World, Slot.SoundEFX, Location);
+	}
+}
+
+void UExplosionSubsystem::Explode(const FVector& Location, const FThrowableSlot& Slot, AActor* Instigator) {
+	UWorld* World = GetWorld();
+
+	PlayEffects(Location, Slot);
+
+	RebuildGridIfStale();
+
+	auto FalloffDamage = [&Slot](float Distance) {
+		float Alpha = FMath::Max(1.0f - Distance / Slot.DamageRadius, 0.0f);
+		return Slot.Damage * FMath::Pow(Alpha, Slot.DamageFalloff);
+	};
+
+	// Gather the targets in range whose falloff damage is still worth applying
+	struct FExplosionTarget
+	{
+		UHealthComponent* Health;
+		FVector Location;
+		float Damage;
+	};
+	TArray<FExplosionTarget, TInlineAllocator<32>> Targets;
+
+	const float RadiusSquared = Slot.DamageRadius * Slot.DamageRadius;
+	FIntPoint MinCell = CellOf(Location - FVector(Slot.DamageRadius));
+	FIntPoint MaxCell = CellOf(Location + FVector(Slot.DamageRadius));
+
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+			const auto* Cell = Grid.Find(FIntPoint(X, Y));
+			if (!Cell) {
+				continue;
+			}
+
+			for (int32 Index : *Cell) {
+				UHealthComponent* Health = Damageables[Index].Get();
+				if (!Health || !Health->GetOwner()) {
+					continue;
+				}
+
+				FVector TargetLocation = Health->GetOwner()->GetActorLocation();
+				float DistanceSquared = FVector::DistSquared(Location, TargetLocation);
+				if (DistanceSquared > RadiusSquared) {
+					continue;
+				}
+
+				float Damage = FalloffDamage(FMath::Sqrt(DistanceSquared));
+				if (Damage >= Slot.MinDamage) {
+					Targets.Add({Health, TargetLocation, Damage});
+				}
+			}
+		}
+	}
+
+	// One batch of occlusion tests against the static world
+	const FCollisionObjectQueryParams StaticObjects(ECC_WorldStatic);
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(ExplosionOcclusion));
+
+	for (const FExplosionTarget& Target : Targets) {
+		bool bOccluded;
+		{
+			// Charged to the thrower, like the overlap below
+			SCOPE_COLLISION_QUERY(Instigator ? static_cast<const UObject*>(Instigator) : this);
+			bOccluded = World->LineTraceTestByObjectType(Location, Target.Location, StaticObjects, Params);
+		}
+		if (!bOccluded) {
+			Target.Health->GetDamage(Target.Damage);
+		}
+	}
+
+	// The props have no health component, they are found by an overlap of their object channel
+	UPropHealthSubsystem* PropHealth = World->GetSubsystem<UPropHealthSubsystem>();
+	if (!PropHealth) {
+		return;
+	}
+
+	PropOverlaps.Reset();
+	{
+		SCOPE_COLLISION_QUERY(Instigator ? static_cast<const UObject*>(Instigator) : this);
+		World->OverlapMultiByObjectType(PropOverlaps, Location, FQuat::Identity, FCollisionObjectQueryParams(ECC_Destructible),
+			FCollisionShape::MakeSphere(Slot.DamageRadius), FCollisionQueryParams(SCENE_QUERY_STAT(ExplosionProps)));
+	}
+
+	for (const FOverlapResult& Overlap : PropOverlaps) {
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (!Component) {
+			continue;
+		}
+
+		// One overlap per instance on the instanced static meshes
+		int32 Instance = Component->IsA<UInstancedStaticMeshComponent>() ? Overlap.ItemIndex : INDEX_NONE;
+		float Damage = FalloffDamage(FVector::Dist(Location, UPropHealthSubsystem::GetPropLocation(Component, Instance)));
+		if (Damage >= Slot.MinDamage) {
+			PropHealth->ApplyDamage(Component, Instance, Damage);
+		}
+	}
+}
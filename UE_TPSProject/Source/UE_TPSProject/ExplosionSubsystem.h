@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FThrowableSlot.h"
+#include "Engine/OverlapResult.h"
+#include "ExplosionSubsystem.generated.h"
+
+class AThrowableActor;
+class UHealthComponent;
+
+/**
+ * Owns the throwable pool and applies radial damage.
+ * Damageable owners register through their UHealthComponent, an explosion looks them up in a
+ * uniform grid instead of a physics overlap, drops the targets under MinDamage and tests the
+ * occlusion of the remaining ones in a single batch of traces. Destructible props in range take the
+ * same falloff damage through UPropHealthSubsystem, they are found by an overlap of their own object
+ * channel, so only the props near an explosion are ever looked at.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UExplosionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Size of a cell of the damageable grid */
+	float CellSize = 1000.0f;
+
+	void RegisterDamageable(UHealthComponent* Health);
+
+	void UnregisterDamageable(UHealthComponent* Health);
+
+	/** Get a throwable from the pool, spawns one if the pool is empty */
+	AThrowableActor* AcquireThrowable();
+
+	void ReleaseThrowable(AThrowableActor* Throwable);
+
+	/** Effects and damage of an explosion, run by the server for its throwables */
+	void Explode(const FVector& Location, const FThrowableSlot& Slot, AActor* Instigator);
+
+	/** Effects of an explosion, alone for the cosmetic throwables of the clients */
+	void PlayEffects(const FVector& Location, const FThrowableSlot& Slot);
+
+private:
+	TArray<TWeakObjectPtr<UHealthComponent>> Damageables;
+
+	UPROPERTY(Transient)
+	TArray<AThrowableActor*> FreeThrowables;
+
+	/** Indices in Damageables, grouped by grid cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Grid;
+
+	/** Frame the grid was built, pawns move so it is rebuilt at most once per frame with explosions */
+	uint64 GridFrame = MAX_uint64;
+
+	/** Results of the prop overlap, kept between explosions so it allocates once */
+	TArray<FOverlapResult> PropOverlaps;
+
+	void RebuildGridIfStale();
+
+	FIntPoint CellOf(const FVector& Location) const;
+};
@@ -0,0 +1,16 @@
+#include "FThrowableSlot.h"
+
+FThrowableSlot::FThrowableSlot() {
+	this->ThrowableMesh = NULL;
+	this->Count = 3;
+	this->ThrowSpeed = 1500.0f;
+	this->ThrowAngle = 15.0f;
+	this->GravityScale = 1.0f;
+	this->FuseTime = 2.5f;
+	this->Damage = 100.0f;
+	this->DamageRadius = 600.0f;
+	this->DamageFalloff = 1.0f;
+	this->MinDamage = 1.0f;
+	this->ExplosionEFX = NULL;
+	this->SoundEFX = NULL;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Engine.h"
+#include "Sound/SoundBase.h"
+#include "FThrowableSlot.generated.h"
+
+USTRUCT(BlueprintType)
+struct FThrowableSlot
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh *ThrowableMesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int Count;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ThrowSpeed;
+
+	/** Pitch added to the aim direction when throwing, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ThrowAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float GravityScale;
+
+	/** Seconds between the throw and the explosion */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float FuseTime;
+
+	/** Damage at the center of the explosion */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Damage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DamageRadius;
+
+	/** Exponent of the damage falloff, 1 is linear */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DamageFalloff;
+
+	/** Targets receiving less than this are skipped before the occlusion test */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinDamage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UParticleSystem* ExplosionEFX;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	USoundBase* SoundEFX;
+
+	FThrowableSlot();
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FWeaponPrediction.generated.h"
+
+/** Kind of weapon action the owning client runs before the server confirms it */
+UENUM()
+enum class EPredictedWeaponAction : uint8
+{
+	Shot,
+	ReloadStart,
+	ReloadEnd
+};
+
+/** A weapon action applied locally and still waiting for the server acknowledgement */
+struct FPredictedWeaponAction
+{
+	uint16 PredictionKey;
+	EPredictedWeaponAction Action;
+};
+
+/** Server-authoritative weapon state, replicated to the owning client for reconciliation */
+USTRUCT()
+struct FAuthoritativeWeaponState
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	/** Bullets left in the magazine on the server */
+	UPROPERTY()
+	int32 MagBullets = 0;
+
+	/** Last prediction key processed by the server, accepted or rejected */
+	UPROPERTY()
+	uint16 LastPredictionKey = 0;
+
+	UPROPERTY()
+	bool bIsReloading = false;
+
+	/** True if Key was generated before (or is) LastKey, taking the uint16 wrap into account */
+	static bool IsKeyAcknowledged(uint16 Key, uint16 LastKey) {
+		return static_cast<int16>(LastKey - Key) >= 0;
+	}
+};
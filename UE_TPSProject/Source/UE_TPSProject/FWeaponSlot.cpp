@@ -5,10 +5,15 @@ FWeaponSlot::FWeaponSlot() {
 	this->MagCapacity = 10;
 	this->IsAutomatic = true;
 	this->Rate = 0.2f;
+	this->BurstCount = 0;
+	this->ReloadTime = 2.0f;
 	this->Damage = 20.0f;
 	this->Range = 10000.0f;
 	this->HitRadius = 50.0f;
 	this->Offset = 55.0f;
+	this->FireMode = EWeaponFireMode::Hitscan;
+	this->MuzzleVelocity = 40000.0f;
+	this->ProjectileGravityScale = 1.0f;
 	this->HitEFX = NULL;
 	this->SoundEFX = NULL;
 }
@@ -4,6 +4,59 @@
 #include "Sound/SoundBase.h"
 #include "FWeaponSlot.generated.h"
 
+/** How a weapon delivers its damage */
+UENUM(BlueprintType)
+enum class EWeaponFireMode : uint8
+{
+	/** Instant trace on the fire frame */
+	Hitscan,
+	/** Simulated round with travel time and drop, see UProjectileSubsystem */
+	Projectile
+};
+
+/** Body part hit by a shot, see UHitboxComponent */
+UENUM(BlueprintType)
+enum class EHitZone : uint8
+{
+	Head,
+	Torso,
+	Arms,
+	Legs
+};
+
+/** Damage multiplier of each body part */
+USTRUCT(BlueprintType)
+struct FHitZoneDamage
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Head = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Torso = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Arms = 0.75f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Legs = 0.75f;
+
+	float GetMultiplier(EHitZone Zone) const {
+		switch (Zone) {
+		case EHitZone::Head:
+			return Head;
+		case EHitZone::Arms:
+			return Arms;
+		case EHitZone::Legs:
+			return Legs;
+		default:
+			return Torso;
+		}
+	}
+};
+
 USTRUCT(BlueprintType)
 struct FWeaponSlot
 {
@@ -22,9 +75,21 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Rate;
 
+	/** Shots per trigger pull of an automatic weapon, 0 fires until the trigger is released */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int BurstCount;
+
+	/** Seconds from the reload start to the full magazine */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ReloadTime;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Damage;
 
+	/** Multipliers of Damage by the body part hit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FHitZoneDamage ZoneDamage;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Range;
 
@@ -34,6 +99,17 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Offset;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EWeaponFireMode FireMode;
+
+	/** Initial speed of the round in projectile mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MuzzleVelocity;
+
+	/** Multiplier of the world gravity applied to the round in projectile mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ProjectileGravityScale;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	UParticleSystem* HitEFX;
 
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FixedStepSubsystem.h"
+
+void UFixedStepSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	float Rate = 0.0f;
+	if (FParse::Value(FCommandLine::Get(), TEXT("FixedStep="), Rate) && Rate > 0.0f) {
+		StepTime = 1.0f / Rate;
+		FParse::Value(FCommandLine::Get(), TEXT("FixedStepMaxSteps="), MaxStepsPerFrame);
+		MaxStepsPerFrame = FMath::Max(MaxStepsPerFrame, 1);
+	}
+}
+
+TStatId UFixedStepSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFixedStepSubsystem, STATGROUP_Tickables);
+}
+
+bool UFixedStepSubsystem::IsTickable() const {
+	return IsEnabled();
+}
+
+void UFixedStepSubsystem::Tick(float DeltaTime) {
+	Accumulator += DeltaTime;
+
+	int32 Steps = 0;
+	while (Accumulator >= StepTime && Steps < MaxStepsPerFrame) {
+		FixedStep.Broadcast(StepTime);
+		Accumulator -= StepTime;
+		Steps++;
+	}
+
+	// Bounded catch-up: a long hitch costs MaxStepsPerFrame steps, the simulation loses the rest
+	if (Accumulator >= StepTime) {
+		Accumulator = FMath::Fmod(Accumulator, StepTime);
+	}
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FixedStepSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FFixedStepDelegate, float /* StepTime */);
+
+/**
+ * Runs the combat and health simulation in fixed increments when the process is started with
+ * -FixedStep=<Hz>: the frame time is accumulated and consumed in steps of 1/Hz, at most
+ * MaxStepsPerFrame per frame, the rest is dropped so an overloaded server slows down instead of
+ * spiralling. Health, latent actions and projectiles run on the steps. Presentation (curves, camera,
+ * turn rates) keeps the frame time.
+ * Meant for headless servers, clients run without the switch: nothing is interpolated between two
+ * steps, a client started with -FixedStep sees health recovery and projectiles advance once per step.
+ * Without -FixedStep the subsystem does not tick and the simulation keeps the frame time.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UFixedStepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+	bool IsEnabled() const { return StepTime > 0.0f; }
+
+	float GetStepTime() const { return StepTime; }
+
+	/** Broadcast once per step, in registration order */
+	FFixedStepDelegate& OnFixedStep() { return FixedStep; }
+
+private:
+	float StepTime = 0.0f;
+
+	float Accumulator = 0.0f;
+
+	/** Catch-up bound, steps beyond it are dropped */
+	int32 MaxStepsPerFrame = 4;
+
+	FFixedStepDelegate FixedStep;
+};
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FrameScratch.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/MallocBase.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DelayedAutoRegister.h"
+#include <atomic>
+
+static FAutoConsoleCommand AllocStatsCommand(
+	TEXT("TPS.AllocStats"),
+	TEXT("Print the heap allocations per frame of the fire, damage and alert paths, needs -CountAllocs. Usage: TPS.AllocStats [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() > 0 && Args[0] == TEXT("reset")) {
+			FFrameScratch::ResetStats();
+		} else {
+			FFrameScratch::DumpStats(*GLog);
+		}
+	}));
+
+namespace FrameScratch
+{
+	/** Scratch of the game thread frame */
+	static TOptional<FMemMark> FrameMark;
+
+#if !UE_BUILD_SHIPPING
+	static constexpr uint8 NoPath = MAX_uint8;
+
+	/** Path charged for the allocations of the thread, trivially initialized so the allocator can read it */
+	static thread_local uint8 CurrentPath = NoPath;
+
+	struct FPathCounts
+	{
+		/** Written by any thread in a scope, read and cleared by the game thread at the end of the frame */
+		std::atomic<uint32> ThisFrame{0};
+
+		uint64 Total = 0;
+		uint32 LastFrame = 0;
+		uint32 MaxFrame = 0;
+		uint32 FramesWithAllocs = 0;
+	};
+
+	static FPathCounts Counts[static_cast<int32>(EHotPath::Count)];
+
+	static uint64 NumFrames = 0;
+
+	static bool bCounting = false;
+
+	/** Forwards everything to the engine allocator, counts the allocations made inside a hot path scope */
+	class FMallocCounter final : public FMalloc
+	{
+	public:
+		explicit FMallocCounter(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override {
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override {
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override {
+			// A realloc to zero is a free
+			if (Count > 0) {
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override {
+			if (Count > 0) {
+				CountAllocation();
+			}
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+		virtual void OnMallocInitialized() override { Inner->OnMallocInitialized(); }
+		virtual void OnPreFork() override { Inner->OnPreFork(); }
+		virtual void OnPostFork() override { Inner->OnPostFork(); }
+
+	private:
+		FMalloc* Inner;
+
+		FORCEINLINE static void CountAllocation() {
+			if (CurrentPath != NoPath) {
+				Counts[CurrentPath].ThisFrame.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	};
+#endif
+}
+
+using namespace FrameScratch;
+
+static FDelayedAutoRegisterHelper FrameScratchRegister(EDelayedRegisterRunPhase::EndOfEngineInit, []() {
+#if !UE_BUILD_SHIPPING
+	// Wrapped once and never unwrapped, the memory allocated before goes back through the proxy to its allocator
+	if (FParse::Param(FCommandLine::Get(), TEXT("CountAllocs"))) {
+		GMalloc = new FMallocCounter(GMalloc);
+		bCounting = true;
+	}
+#endif
+
+	FCoreDelegates::OnBeginFrame.AddStatic(&FFrameScratch::BeginFrame);
+	FCoreDelegates::OnEndFrame.AddStatic(&FFrameScratch::EndFrame);
+	// The mark must not be popped by the static destructors, after the thread stacks are gone
+	FCoreDelegates::OnPreExit.AddStatic(&FFrameScratch::EndFrame);
+});
+
+void FFrameScratch::BeginFrame() {
+	check(IsInGameThread());
+	FrameMark.Reset();
+	FrameMark.Emplace(FMemStack::Get());
+}
+
+void FFrameScratch::EndFrame() {
+	check(IsInGameThread());
+	FrameMark.Reset();
+
+#if !UE_BUILD_SHIPPING
+	if (!bCounting) {
+		return;
+	}
+
+	NumFrames++;
+	for (FPathCounts& Path : Counts) {
+		uint32 Frame = Path.ThisFrame.exchange(0, std::memory_order_relaxed);
+		Path.Total += Frame;
+		Path.LastFrame = Frame;
+		Path.MaxFrame = FMath::Max(Path.MaxFrame, Frame);
+		Path.FramesWithAllocs += Frame > 0 ? 1 : 0;
+	}
+#endif
+}
+
+bool FFrameScratch::IsCounting() {
+#if !UE_BUILD_SHIPPING
+	return bCounting;
+#else
+	return false;
+#endif
+}
+
+void FFrameScratch::DumpStats(FOutputDevice& Ar) {
+#if !UE_BUILD_SHIPPING
+	if (!bCounting) {
+		Ar.Logf(TEXT("Allocation counters are off, start with -CountAllocs"));
+		return;
+	}
+
+	static const TCHAR* PathNames[] = {TEXT("Fire"), TEXT("Damage"), TEXT("Alert")};
+	static_assert(UE_ARRAY_COUNT(PathNames) == static_cast<int32>(EHotPath::Count), "One name per hot path");
+
+	Ar.Logf(TEXT("Heap allocations over %llu frames:"), NumFrames);
+	for (int32 Path = 0; Path < static_cast<int32>(EHotPath::Count); Path++) {
+		const FPathCounts& PathCounts = Counts[Path];
+		Ar.Logf(TEXT("  %-8s total %llu, last frame %u, max per frame %u, frames with allocations %u"),
+			PathNames[Path], PathCounts.Total, PathCounts.LastFrame, PathCounts.MaxFrame, PathCounts.FramesWithAllocs);
+	}
+#endif
+}
+
+void FFrameScratch::ResetStats() {
+#if !UE_BUILD_SHIPPING
+	NumFrames = 0;
+	for (FPathCounts& Path : Counts) {
+		Path.ThisFrame.store(0, std::memory_order_relaxed);
+		Path.Total = 0;
+		Path.LastFrame = 0;
+		Path.MaxFrame = 0;
+		Path.FramesWithAllocs = 0;
+	}
+#endif
+}
+
+#if !UE_BUILD_SHIPPING
+
+FScopedHotPath::FScopedHotPath(EHotPath Path) : PreviousPath(CurrentPath) {
+	CurrentPath = static_cast<uint8>(Path);
+}
+
+FScopedHotPath::~FScopedHotPath() {
+	CurrentPath = PreviousPath;
+}
+
+#endif
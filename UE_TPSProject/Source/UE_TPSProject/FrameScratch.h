@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * Scratch memory of the combat and AI hot paths.
+ * Containers using FScratchAllocator take their memory from the FMemStack of the calling thread, a
+ * linear arena: an allocation is a pointer bump and nothing is freed one by one. On the game thread
+ * FFrameScratch pushes a mark when a frame begins and pops it when the frame ends, releasing the
+ * scratch of the whole frame at once. Worker tasks open their own FMemMark around the scratch they use.
+ * Scratch containers are locals: they must not outlive the frame, or the task, that made them.
+ */
+using FScratchAllocator = TMemStackAllocator<>;
+
+template<typename T>
+using TScratchArray = TArray<T, FScratchAllocator>;
+
+/** Hot paths whose heap allocations are counted */
+enum class EHotPath : uint8
+{
+	Fire,
+	Damage,
+	Alert,
+
+	Count
+};
+
+/**
+ * Frame mark of the game thread scratch, and the heap allocation counters of the hot paths.
+ * The counters only run when the process is started with -CountAllocs: the engine allocator is then
+ * wrapped by a proxy charging each allocation to the hot path open on the calling thread.
+ * TPS.AllocStats prints the allocations per frame of every path.
+ */
+class UE_TPSPROJECT_API FFrameScratch
+{
+public:
+	static void BeginFrame();
+
+	static void EndFrame();
+
+	static bool IsCounting();
+
+	/** Log the allocations of every path, since the start or the last reset */
+	static void DumpStats(FOutputDevice& Ar);
+
+	static void ResetStats();
+};
+
+#if !UE_BUILD_SHIPPING
+
+/** Charge the heap allocations made by this thread to Path while alive, the innermost scope wins */
+struct UE_TPSPROJECT_API FScopedHotPath
+{
+	explicit FScopedHotPath(EHotPath Path);
+
+	~FScopedHotPath();
+
+private:
+	uint8 PreviousPath;
+};
+
+#define SCOPE_HOT_PATH(Path) FScopedHotPath PREPROCESSOR_JOIN(HotPathScope, __LINE__)(EHotPath::Path)
+
+#else
+
+#define SCOPE_HOT_PATH(Path)
+
+#endif
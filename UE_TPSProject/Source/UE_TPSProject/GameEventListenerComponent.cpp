@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameEventListenerComponent.h"
+
+UGameEventListenerComponent::UGameEventListenerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UGameEventListenerComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>();
+	if (!Events) {
+		return;
+	}
+
+	const AActor* Relayed = Source ? Source : GetOwner();
+	for (int32 Channel = 0; Channel < static_cast<int32>(EGameEvent::Count); Channel++) {
+		Events->Subscribe(static_cast<EGameEvent>(Channel), this, Relayed,
+			FGameEventDelegate::CreateUObject(this, &UGameEventListenerComponent::RelayEvent));
+	}
+}
+
+void UGameEventListenerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Unsubscribe(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGameEventListenerComponent::RelayEvent(const FGameEvent& Event) {
+	OnGameEvent.Broadcast(Event.Type, Event.Value);
+}
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameEventSubsystem.h"
+#include "GameEventListenerComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGameEventListenerDelegate, EGameEvent, Event, float, Value);
+
+/**
+ * Blueprint adapter of the gameplay event bus: relays the events of its owner, or of Source if
+ * set, to OnGameEvent. Add it to the Blueprints that bound the former OnCharacter* and health
+ * delegates, the other actors pay nothing for the events.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class UE_TPSPROJECT_API UGameEventListenerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGameEventListenerComponent();
+
+	/** Actor whose events are relayed, the owner if null */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Events")
+	AActor* Source;
+
+	/** Broadcasted for every event of the source */
+	UPROPERTY(BlueprintAssignable)
+	FGameEventListenerDelegate OnGameEvent;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void RelayEvent(const FGameEvent& Event);
+};
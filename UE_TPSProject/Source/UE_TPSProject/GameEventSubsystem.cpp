@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameEventSubsystem.h"
+
+TStatId UGameEventSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameEventSubsystem, STATGROUP_Tickables);
+}
+
+bool UGameEventSubsystem::IsTickable() const {
+	return Queue.Num() > 0;
+}
+
+void UGameEventSubsystem::Post(const AActor* Source, EGameEvent Type, float Value) {
+	UWorld* World = Source ? Source->GetWorld() : nullptr;
+	UGameEventSubsystem* Events = World ? World->GetSubsystem<UGameEventSubsystem>() : nullptr;
+
+	if (Events) {
+		Events->Queue.Add({const_cast<AActor*>(Source), Type, Value});
+	}
+}
+
+void UGameEventSubsystem::Subscribe(EGameEvent Channel, const UObject* Listener, const AActor* Source, FGameEventDelegate Delegate) {
+	FSubscription Subscription{Listener, Source, MoveTemp(Delegate)};
+
+	if (bDispatching) {
+		PendingSubscriptions.Emplace(Channel, MoveTemp(Subscription));
+	} else {
+		Channels[static_cast<int32>(Channel)].Add(MoveTemp(Subscription));
+	}
+}
+
+void UGameEventSubsystem::SubscribeBlueprint(EGameEvent Channel, AActor* Source, FGameEventBlueprintDelegate Delegate) {
+	UObject* Listener = Delegate.GetUObject();
+	if (!Listener) {
+		return;
+	}
+
+	Subscribe(Channel, Listener, Source, FGameEventDelegate::CreateWeakLambda(Listener, [Delegate](const FGameEvent& Event) {
+		Delegate.ExecuteIfBound(Event.Type, Event.Value);
+	}));
+}
+
+void UGameEventSubsystem::Unsubscribe(const UObject* Listener) {
+	// Only cleared here, the arrays are compacted once no dispatch is walking them
+	for (TArray<FSubscription>& Channel : Channels) {
+		for (FSubscription& Subscription : Channel) {
+			if (Subscription.Listener == Listener) {
+				Subscription.Listener = nullptr;
+				bHasRemovedSubscriptions = true;
+			}
+		}
+	}
+
+	PendingSubscriptions.RemoveAll([Listener](const TPair<EGameEvent, FSubscription>& Pending) {
+		return Pending.Value.Listener == Listener;
+	});
+}
+
+void UGameEventSubsystem::Tick(float DeltaTime) {
+	// Events posted by the listeners go in the next round, a few rounds at most per frame
+	for (int32 Round = 0; Round < 4 && Queue.Num() > 0; Round++) {
+		// Swapped rather than moved, both buffers keep their capacity from frame to frame
+		Swap(Queue, DispatchBatch);
+		Dispatch(DispatchBatch);
+		DispatchBatch.Reset();
+	}
+}
+
+void UGameEventSubsystem::Dispatch(const TArray<FGameEvent>& Batch) {
+	bDispatching = true;
+
+	for (const FGameEvent& Event : Batch) {
+		const AActor* Source = Event.Source.Get();
+		if (!Source) {
+			continue;
+		}
+
+		for (const FSubscription& Subscription : Channels[static_cast<int32>(Event.Type)]) {
+			if (!Subscription.Listener.IsValid()) {
+				bHasRemovedSubscriptions = true;
+				continue;
+			}
+
+			if (Subscription.Source.IsExplicitlyNull() || Subscription.Source.Get() == Source) {
+				Subscription.Delegate.ExecuteIfBound(Event);
+			}
+		}
+	}
+
+	bDispatching = false;
+
+	for (TPair<EGameEvent, FSubscription>& Pending : PendingSubscriptions) {
+		Channels[static_cast<int32>(Pending.Key)].Add(MoveTemp(Pending.Value));
+	}
+	PendingSubscriptions.Reset();
+
+	RemoveStaleSubscriptions();
+}
+
+void UGameEventSubsystem::RemoveStaleSubscriptions() {
+	if (!bHasRemovedSubscriptions) {
+		return;
+	}
+
+	for (TArray<FSubscription>& Channel : Channels) {
+		Channel.RemoveAll([](const FSubscription& Subscription) {
+			return !Subscription.Listener.IsValid();
+		});
+	}
+	bHasRemovedSubscriptions = false;
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameEventSubsystem.generated.h"
+
+/** Gameplay event channels, one per former per-instance delegate */
+UENUM(BlueprintType)
+enum class EGameEvent : uint8
+{
+	Landing,
+	Jumping,
+	Crouch,
+	Uncrouch,
+	Aim,
+	StopAim,
+	StartReload,
+	TraceLine,
+	StartSprint,
+	EndSprint,
+	/** Value: damage amount */
+	Damaged,
+	HealthZero,
+	HealthRecovered,
+
+	Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FGameEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	TWeakObjectPtr<AActor> Source;
+
+	UPROPERTY(BlueprintReadOnly)
+	EGameEvent Type = EGameEvent::Landing;
+
+	UPROPERTY(BlueprintReadOnly)
+	float Value = 0.0f;
+};
+
+DECLARE_DELEGATE_OneParam(FGameEventDelegate, const FGameEvent&);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FGameEventBlueprintDelegate, EGameEvent, Event, float, Value);
+
+/**
+ * Typed gameplay event bus. Actors post compact event records instead of broadcasting their own
+ * dynamic delegates, listeners subscribe to a channel, optionally for a single source actor.
+ * Posted events are queued and dispatched in one batch per frame, after the actors have ticked.
+ * Blueprint actors listen through UGameEventListenerComponent, other Blueprints through SubscribeBlueprint.
+ * The characters still broadcast the few OnCharacter* delegates the anim and character Blueprints bind.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UGameEventSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue an event of Source for the next dispatch */
+	static void Post(const AActor* Source, EGameEvent Type, float Value = 0.0f);
+
+	/**
+	 * Call Delegate for the events of Channel. Source limits the subscription to the events of one
+	 * actor, any actor if null. The subscription ends with Unsubscribe or when Listener is destroyed.
+	 */
+	void Subscribe(EGameEvent Channel, const UObject* Listener, const AActor* Source, FGameEventDelegate Delegate);
+
+	/** Remove every subscription of Listener */
+	void Unsubscribe(const UObject* Listener);
+
+	/**
+	 * Subscribe of the Blueprints, for the listeners that can't own a UGameEventListenerComponent such as
+	 * the anim instances. The object bound to Delegate is the listener.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Events", meta = (DisplayName = "Subscribe To Game Event"))
+	void SubscribeBlueprint(EGameEvent Channel, AActor* Source, FGameEventBlueprintDelegate Delegate);
+
+	UFUNCTION(BlueprintCallable, Category = "Events", meta = (DisplayName = "Unsubscribe From Game Events"))
+	void UnsubscribeBlueprint(UObject* Listener) { Unsubscribe(Listener); }
+
+private:
+	struct FSubscription
+	{
+		TWeakObjectPtr<const UObject> Listener;
+		TWeakObjectPtr<const AActor> Source;
+		FGameEventDelegate Delegate;
+	};
+
+	/** Subscriptions by channel */
+	TArray<FSubscription> Channels[static_cast<int32>(EGameEvent::Count)];
+
+	TArray<FGameEvent> Queue;
+
+	/** Events being dispatched, swapped with Queue */
+	TArray<FGameEvent> DispatchBatch;
+
+	/** Subscriptions made by the listeners while dispatching, added after the batch */
+	TArray<TPair<EGameEvent, FSubscription>> PendingSubscriptions;
+
+	bool bDispatching = false;
+
+	bool bHasRemovedSubscriptions = false;
+
+	void Dispatch(const TArray<FGameEvent>& Batch);
+
+	void RemoveStaleSubscriptions();
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Gameplay rules with no UObject or world dependency: health damage and recovery, patrol stepping.
+// Plain C++ on purpose, UHealthComponent and AEnemyPath call into it and Tools/CoreBenchmark runs it
+// over millions of entities outside the engine. Times are world seconds passed in by the caller.
+// The weapon cadence is not here, the shots of a trigger pull are a latent action of the character.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace GameplayCore
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Health
+
+	struct FRecoveryParams
+	{
+		bool bAutoRecovery;
+		/** Health given back every HealthRecoveryTime */
+		float RecoveryQuantity;
+		float HealthRecoveryTime;
+		/** Time without damage before the recovery starts again */
+		float NoDamageTimeForRecovery;
+	};
+
+	struct FRecoveryState
+	{
+		float ElapsedTime = 0.0f;
+		float LastDamageTime = 0.0f;
+		bool bIsDamaged = false;
+	};
+
+	inline float ClampHealth(float Health, float MaxHealth) {
+		return std::min(std::max(Health, 0.0f), MaxHealth);
+	}
+
+	/** Remove Amount from Health and stop the recovery, true if Health reached zero */
+	inline bool ApplyDamage(float& Health, float MaxHealth, FRecoveryState& Recovery, float Amount, float Now) {
+		Health = ClampHealth(Health - Amount, MaxHealth);
+		Recovery.bIsDamaged = true;
+		Recovery.LastDamageTime = Now;
+		return Health <= 0.0f;
+	}
+
+	/** One frame of recovery followed by the damage timer, true if health was given back this frame */
+	inline bool TickRecovery(float& Health, float MaxHealth, FRecoveryState& Recovery, const FRecoveryParams& Params, float DeltaTime, float Now) {
+		bool bRecovered = false;
+
+		if (Params.bAutoRecovery && !Recovery.bIsDamaged) {
+			Recovery.ElapsedTime += DeltaTime;
+
+			if (Recovery.ElapsedTime >= Params.HealthRecoveryTime) {
+				Recovery.ElapsedTime = 0.0f;
+				Health = ClampHealth(Health + Params.RecoveryQuantity, MaxHealth);
+				bRecovered = true;
+			}
+		}
+
+		if (Recovery.bIsDamaged && Now - Recovery.LastDamageTime >= Params.NoDamageTimeForRecovery) {
+			Recovery.bIsDamaged = false;
+		}
+		return bRecovered;
+	}
+
+	/**
+	 * TickRecovery over Count entities stored as separate arrays, without branches so the compiler
+	 * can vectorize the loop. Same results as calling TickRecovery on every entity.
+	 */
+	inline void TickRecoveryBatch(float* Health, const float* MaxHealth, float* ElapsedTime, const float* LastDamageTime, uint8_t* IsDamaged,
+		size_t Count, const FRecoveryParams& Params, float DeltaTime, float Now) {
+		const float AutoRecovery = Params.bAutoRecovery ? 1.0f : 0.0f;
+
+		for (size_t Index = 0; Index < Count; Index++) {
+			const float Recovering = AutoRecovery * (IsDamaged[Index] ? 0.0f : 1.0f);
+			const float Elapsed = ElapsedTime[Index] + DeltaTime * Recovering;
+			const bool bDue = Recovering > 0.0f && Elapsed >= Params.HealthRecoveryTime;
+
+			ElapsedTime[Index] = bDue ? 0.0f : Elapsed;
+			Health[Index] = bDue ? std::min(std::max(Health[Index] + Params.RecoveryQuantity, 0.0f), MaxHealth[Index]) : Health[Index];
+			IsDamaged[Index] = IsDamaged[Index] & static_cast<uint8_t>(Now - LastDamageTime[Index] < Params.NoDamageTimeForRecovery);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Patrol
+
+	struct FPatrolCursor
+	{
+		int32_t Index = 0;
+		/** 1 going forward, -1 backtracking the path */
+		int32_t Sense = 1;
+	};
+
+	/** Move to the next point of a path of NumPoints, the patrol turns back at both ends */
+	inline void StepPatrol(FPatrolCursor& Cursor, int32_t NumPoints) {
+		if (NumPoints < 2) {
+			Cursor.Index = 0;
+			return;
+		}
+
+		Cursor.Index += Cursor.Sense;
+		if (Cursor.Index == NumPoints - 1 || Cursor.Index == 0) {
+			Cursor.Sense = -Cursor.Sense;
+		}
+	}
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HUDViewModelComponent.h"
+
+UHUDViewModelComponent::UHUDViewModelComponent() {
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UHUDViewModelComponent::SetHealth(float InHealthPercentage) {
+	if (HealthPercentage == InHealthPercentage) {
+		return;
+	}
+
+	HealthPercentage = InHealthPercentage;
+	OnHealthChanged.Broadcast(HealthPercentage);
+}
+
+void UHUDViewModelComponent::SetAmmo(int32 InMagBullets, int32 InMagCapacity) {
+	if (MagBullets == InMagBullets && MagCapacity == InMagCapacity) {
+		return;
+	}
+
+	MagBullets = InMagBullets;
+	MagCapacity = InMagCapacity;
+	OnAmmoChanged.Broadcast(MagBullets, MagCapacity);
+}
+
+void UHUDViewModelComponent::SetWeapon(int32 InWeaponIndex) {
+	if (WeaponIndex == InWeaponIndex) {
+		return;
+	}
+
+	WeaponIndex = InWeaponIndex;
+	OnWeaponChanged.Broadcast(WeaponIndex);
+}
+
+void UHUDViewModelComponent::SetAim(bool bInAimingWithWeapon, bool bInAimingWithArch) {
+	if (bAimingWithWeapon == bInAimingWithWeapon && bAimingWithArch == bInAimingWithArch) {
+		return;
+	}
+
+	bAimingWithWeapon = bInAimingWithWeapon;
+	bAimingWithArch = bInAimingWithArch;
+	OnAimChanged.Broadcast(bAimingWithWeapon, bAimingWithArch);
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HUDViewModelComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHUDHealthChanged, float, HealthPercentage);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHUDAmmoChanged, int32, MagBullets, int32, MagCapacity);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHUDWeaponChanged, int32, WeaponIndex);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHUDAimChanged, bool, bAimingWithWeapon, bool, bAimingWithArch);
+
+/**
+ * State shown by the HUD, pushed by the health component and the character when it changes.
+ * Widgets read the values once when created, then update from the On*Changed notifications
+ * instead of binding their properties to getters evaluated every frame.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class UE_TPSPROJECT_API UHUDViewModelComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHUDViewModelComponent();
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	float HealthPercentage = 1.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	int32 MagBullets = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	int32 MagCapacity = 0;
+
+	/** Index in the character Arsenal, the widget reads the slot it needs only when this changes */
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	int32 WeaponIndex = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	bool bAimingWithWeapon = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	bool bAimingWithArch = false;
+
+	UPROPERTY(BlueprintAssignable)
+	FHUDHealthChanged OnHealthChanged;
+
+	UPROPERTY(BlueprintAssignable)
+	FHUDAmmoChanged OnAmmoChanged;
+
+	UPROPERTY(BlueprintAssignable)
+	FHUDWeaponChanged OnWeaponChanged;
+
+	UPROPERTY(BlueprintAssignable)
+	FHUDAimChanged OnAimChanged;
+
+	// Setters broadcast only when the value differs from the one shown
+	void SetHealth(float InHealthPercentage);
+	void SetAmmo(int32 InMagBullets, int32 InMagCapacity);
+	void SetWeapon(int32 InWeaponIndex);
+	void SetAim(bool bInAimingWithWeapon, bool bInAimingWithArch);
+};
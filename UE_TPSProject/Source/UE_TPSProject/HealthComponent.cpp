@@ -2,6 +2,15 @@
 
 #include "HealthComponent.h"
 
+#include "UE_TPSProject.h"
+#include "CombatRecorderSubsystem.h"
+#include "CombatTelemetry.h"
+#include "ExplosionSubsystem.h"
+#include "FixedStepSubsystem.h"
+#include "FrameScratch.h"
+#include "GameEventSubsystem.h"
+#include "HUDViewModelComponent.h"
+
 // Sets default values for this component's properties
 UHealthComponent::UHealthComponent()
 {
@@ -13,56 +22,92 @@ void UHealthComponent::BeginPlay() {
 	
 	HealthDefaultValue = Health;
 	HealthMaxValue = Health;
-	ElapsedTime = 0.0f;
-	TimeSinceLastDamage = 0.0f;
-	bIsDamaged = false;
+	Recovery = GameplayCore::FRecoveryState();
+
+	ViewModel = GetOwner()->FindComponentByClass<UHUDViewModelComponent>();
+	PushHealth();
+
+	// In fixed-step mode the recovery advances with the simulation steps instead of the frames
+	UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStep && FixedStep->IsEnabled()) {
+		SetComponentTickEnabled(false);
+		FixedStepHandle = FixedStep->OnFixedStep().AddUObject(this, &UHealthComponent::StepRecovery);
+	}
+
+	// Make the owner reachable by radial damage
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>()) {
+		Explosions->RegisterDamageable(this);
+	}
+}
+
+void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>()) {
+		FixedStep->OnFixedStep().Remove(FixedStepHandle);
+	}
+	if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>()) {
+		Explosions->UnregisterDamageable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UHealthComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	AutoRecoveryHealth(DeltaTime);
-	CheckDamageTime(DeltaTime);
+	StepRecovery(DeltaTime);
+}
+
+void UHealthComponent::StepRecovery(float DeltaTime) {
+	GameplayCore::FRecoveryParams Params{bAutoRecovery, RecoveryQuantity, HealthRecoveryTime, NoDamageTimeForRecovery};
+	if (GameplayCore::TickRecovery(Health, HealthMaxValue, Recovery, Params, DeltaTime, GetWorld()->GetTimeSeconds())) {
+		UGameEventSubsystem::Post(GetOwner(), EGameEvent::HealthRecovered);
+		PushHealth();
+	}
 }
 
 void UHealthComponent::GetDamage(float Amount) {
-	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Took damage"));
-	
-	Health = FMath::Clamp(Health - Amount, 0.0f, HealthMaxValue);
-	bIsDamaged = true;
-	TimeSinceLastDamage = GetWorld()->GetTimeSeconds();
-	OnGetDamage.Broadcast();
-	if (Health <= 0) {
-		OnHealtToZero.Broadcast();
+	SCOPE_HOT_PATH(Damage);
+
+	if (ShouldPlayCosmetics(GetWorld())) {
+		GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Took damage"));
+	}
+
+	bool bWasAlive = Health > 0;
+	bool bDead = GameplayCore::ApplyDamage(Health, HealthMaxValue, Recovery, Amount, GetWorld()->GetTimeSeconds());
+	UCombatRecorderSubsystem::RecordEvent(this, ECombatRecordEvent::Damage, GetOwner(), Amount);
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::Damage, nullptr, GetOwner(), Amount);
+	UGameEventSubsystem::Post(GetOwner(), EGameEvent::Damaged, Amount);
+	PushHealth();
+	// Only once, the owner may keep taking hits until its death is handled
+	if (bDead && bWasAlive) {
+		UGameEventSubsystem::Post(GetOwner(), EGameEvent::HealthZero);
 	}
 }
 
 void UHealthComponent::IncrementMaxHealth(float Amount) {
 	HealthMaxValue += Amount;
+	PushHealth();
 }
 
 void UHealthComponent::Healing(float Amount) {
-	Health = FMath::Clamp(Health + Amount, 0.0f, HealthMaxValue);
+	Health = GameplayCore::ClampHealth(Health + Amount, HealthMaxValue);
+	PushHealth();
 }
 
-void UHealthComponent::CheckDamageTime(float DeltaTime) {
-	if (bIsDamaged) {
-		float ActualTime = GetWorld()->GetTimeSeconds();
-		if ((ActualTime - TimeSinceLastDamage) >= NoDamageTimeForRecovery) {
-			bIsDamaged = false;
-		}
+void UHealthComponent::RestoreHealth(float InHealth, float InMaxHealth) {
+	HealthMaxValue = InMaxHealth;
+	Health = GameplayCore::ClampHealth(InHealth, HealthMaxValue);
+	Recovery = GameplayCore::FRecoveryState();
+	PushHealth();
+
+	if (Health <= 0) {
+		UGameEventSubsystem::Post(GetOwner(), EGameEvent::HealthZero);
 	}
 }
 
-void UHealthComponent::AutoRecoveryHealth(float DeltaTime) {
-	if (bAutoRecovery && !bIsDamaged) {
-		ElapsedTime += DeltaTime;
-		
-		if (ElapsedTime >= HealthRecoveryTime) {
-			ElapsedTime = 0.0f;
-			Healing(RecoveryQuantity);
-			OnHealthRecovery.Broadcast();
-		}		
+void UHealthComponent::PushHealth() {
+	if (ViewModel) {
+		ViewModel->SetHealth(HealthPercentage());
 	}
 }
 
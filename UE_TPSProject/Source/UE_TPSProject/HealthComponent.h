@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "GameplayCore.h"
 #include "HealthComponent.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FHealtDelegate);
+class UHUDViewModelComponent;
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class UE_TPSPROJECT_API UHealthComponent : public UActorComponent
 {
@@ -17,33 +19,27 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
 	float HealthDefaultValue;
 	float HealthMaxValue;
-	float ElapsedTime;
-	float TimeSinceLastDamage;
-	bool bIsDamaged;
+	GameplayCore::FRecoveryState Recovery;
 
-	void AutoRecoveryHealth(float DeltaTime);
+	/** View model of the owner HUD, null for the actors without one */
+	UPROPERTY(Transient)
+	UHUDViewModelComponent* ViewModel;
 
-	void CheckDamageTime(float DeltaTime);
+	void PushHealth();
 
-public:
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	FDelegateHandle FixedStepHandle;
 
-	/** Brodcasted when the actor get damage */
-	UPROPERTY(BlueprintAssignable)
-	FHealtDelegate OnGetDamage;
+	/** Recovery and damage timer over DeltaTime, run by the component tick or by UFixedStepSubsystem */
+	void StepRecovery(float DeltaTime);
 
-	/** Broadcasted when Health values is <= 0 */
-	UPROPERTY(BlueprintAssignable)
-	FHealtDelegate OnHealtToZero;
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-	/** Broadcasted every time Health is recovered */
-	UPROPERTY(BlueprintAssignable)
-	FHealtDelegate OnHealthRecovery;
-	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Healt: variables")
 	float Health;
 
@@ -60,12 +56,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Healt: variables")
 	float NoDamageTimeForRecovery = 2.5f;
 
+	/** Posts Damaged to the event bus, and HealthZero when the health drops to zero */
 	UFUNCTION(BlueprintCallable)
 	void GetDamage(float Amount);
 
 	void IncrementMaxHealth(float Amount);
 
 	void Healing(float Amount);
+
+	FORCEINLINE float GetMaxHealth() const { return HealthMaxValue; }
+
+	/** Set the values read from a mission save, posts HealthZero if the owner was saved dead */
+	void RestoreHealth(float InHealth, float InMaxHealth);
 	
 	/** Retrieve the health percentage */
 	UFUNCTION(BlueprintCallable, Category = "Health")
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HitboxComponent.h"
+
+#include "FrameScratch.h"
+#include "Components/SkeletalMeshComponent.h"
+
+UHitboxComponent::UHitboxComponent() {
+	PrimaryComponentTick.bCanEverTick = false;
+
+	Proxies = {
+		{ TEXT("head"), TEXT("neck_01"), 14.0f, EHitZone::Head },
+		{ TEXT("pelvis"), TEXT("spine_03"), 22.0f, EHitZone::Torso },
+		{ TEXT("upperarm_l"), TEXT("hand_l"), 8.0f, EHitZone::Arms },
+		{ TEXT("upperarm_r"), TEXT("hand_r"), 8.0f, EHitZone::Arms },
+		{ TEXT("thigh_l"), TEXT("foot_l"), 10.0f, EHitZone::Legs },
+		{ TEXT("thigh_r"), TEXT("foot_r"), 10.0f, EHitZone::Legs },
+	};
+}
+
+void UHitboxComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	Mesh = GetOwner()->FindComponentByClass<USkinnedMeshComponent>();
+	if (!Mesh) {
+		return;
+	}
+
+	// A dedicated server renders nothing, by default it would stop refreshing the bones the proxies read
+	if (GetNetMode() == NM_DedicatedServer) {
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	}
+
+	for (const FHitboxProxy& Proxy : Proxies) {
+		int32 StartBone = Mesh->GetBoneIndex(Proxy.StartBone);
+		int32 EndBone = Mesh->GetBoneIndex(Proxy.EndBone);
+		if (StartBone == INDEX_NONE || EndBone == INDEX_NONE) {
+			continue;
+		}
+
+		StartBones.Add(StartBone);
+		EndBones.Add(EndBone);
+		Radii.Add(Proxy.Radius);
+		Zones.Add(Proxy.Zone);
+	}
+
+	if (StartBones.Num() == 0) {
+		return;
+	}
+
+	Starts.SetNumUninitialized(StartBones.Num());
+	Ends.SetNumUninitialized(StartBones.Num());
+	Refresh();
+
+	// Spread the refreshes so pawns spawned together don't read their skeletons on the same frame
+	GetWorld()->GetTimerManager().SetTimer(RefreshTimer, this, &UHitboxComponent::Refresh,
+		RefreshInterval, true, FMath::FRandRange(0.0f, RefreshInterval));
+}
+
+void UHitboxComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	GetWorld()->GetTimerManager().ClearTimer(RefreshTimer);
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHitboxComponent::Refresh() {
+	// The animation budget can still hold the pose of a mesh, the proxies are then as old as that pose
+	if (const USkeletalMeshComponent* Skeletal = Cast<USkeletalMeshComponent>(Mesh)) {
+		bStalePose = Skeletal->LastPoseTickFrame == RefreshedPoseFrame;
+		RefreshedPoseFrame = Skeletal->LastPoseTickFrame;
+	}
+
+	const FTransform& ActorTransform = GetOwner()->GetActorTransform();
+	BoundsRadius = 0.0f;
+
+	for (int32 Index = 0; Index < StartBones.Num(); Index++) {
+		Starts[Index] = ActorTransform.InverseTransformPosition(Mesh->GetBoneTransform(StartBones[Index]).GetLocation());
+		Ends[Index] = ActorTransform.InverseTransformPosition(Mesh->GetBoneTransform(EndBones[Index]).GetLocation());
+		BoundsRadius = FMath::Max(BoundsRadius, static_cast<float>(FMath::Max(Starts[Index].Size(), Ends[Index].Size())) + Radii[Index]);
+	}
+}
+
+bool UHitboxComponent::TraceProxies(const FVector& Origin, const FVector& Direction, float Radius, EHitZone& Zone) const {
+	if (Starts.Num() == 0) {
+		return false;
+	}
+
+	// Work in actor space, where the proxies are stored, and stop the shot past the far side of the bounds
+	const FTransform& ActorTransform = GetOwner()->GetActorTransform();
+	FVector ShotStart(ActorTransform.InverseTransformPosition(Origin));
+	FVector ShotDirection(ActorTransform.InverseTransformVectorNoScale(Direction).GetSafeNormal());
+	FVector ShotEnd = ShotStart + ShotDirection * (ShotStart.Size() + BoundsRadius);
+
+	if (FMath::PointDistToSegmentSquared(FVector::ZeroVector, ShotStart, ShotEnd) > FMath::Square(BoundsRadius + Radius)) {
+		return false;
+	}
+
+	double NearestDistance = TNumericLimits<double>::Max();
+	for (int32 Index = 0; Index < Starts.Num(); Index++) {
+		FVector OnShot;
+		FVector OnProxy;
+		FMath::SegmentDistToSegmentSafe(ShotStart, ShotEnd, Starts[Index], Ends[Index], OnShot, OnProxy);
+		if (FVector::DistSquared(OnShot, OnProxy) > FMath::Square(Radii[Index] + Radius)) {
+			continue;
+		}
+
+		// The first proxy along the shot takes it, a head behind an arm is not a headshot
+		double Distance = FVector::DistSquared(ShotStart, OnShot);
+		if (Distance < NearestDistance) {
+			NearestDistance = Distance;
+			Zone = Zones[Index];
+		}
+	}
+	return NearestDistance < TNumericLimits<double>::Max();
+}
+
+float UHitboxComponent::ComputeDamage(const AActor* Target, float Damage, const FHitZoneDamage& ZoneDamage,
+	const FVector& Origin, const FVector& Direction, float Radius) {
+	SCOPE_HOT_PATH(Damage);
+
+	const UHitboxComponent* Hitbox = Target ? Target->FindComponentByClass<UHitboxComponent>() : nullptr;
+	if (!Hitbox || Hitbox->Starts.Num() == 0) {
+		return Damage;
+	}
+
+	EHitZone Zone;
+	if (!Hitbox->TraceProxies(Origin, Direction, Radius, Zone)) {
+		// The body may have moved away from old proxies, the shot that reached the capsule takes the torso
+		if (!Hitbox->bStalePose) {
+			return 0.0f;
+		}
+		Zone = EHitZone::Torso;
+	}
+	return Damage * ZoneDamage.GetMultiplier(Zone);
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FWeaponSlot.h"
+#include "HitboxComponent.generated.h"
+
+/** Capsule between two bones of the owner mesh */
+USTRUCT(BlueprintType)
+struct FHitboxProxy
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName StartBone;
+
+	/** Same as StartBone for a sphere */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName EndBone;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Radius = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EHitZone Zone = EHitZone::Torso;
+};
+
+/**
+ * Locational damage without tracing the physics asset: a few analytic capsules follow the skeleton
+ * at a reduced rate, and the shots that reach the pawn capsule are tested against them.
+ * The capsules are kept in actor space, so between two refreshes only the animation is late, not the movement.
+ * A dedicated server keeps refreshing the bones of its unrendered meshes. A budgeted mesh may still skip its pose for
+ * a while, a shot missing proxies built from a pose that didn't tick since the last refresh hits the torso.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class UE_TPSPROJECT_API UHitboxComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHitboxComponent();
+
+	/** Body parts tested by the shots, defaults match the mannequin skeleton */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hitbox")
+	TArray<FHitboxProxy> Proxies;
+
+	/** Seconds between two reads of the bone positions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hitbox")
+	float RefreshInterval = 0.1f;
+
+	/**
+	 * Nearest proxy crossed by the shot from Origin along Direction, swept by a sphere of Radius.
+	 * @return False if the shot passes between the proxies
+	 */
+	bool TraceProxies(const FVector& Origin, const FVector& Direction, float Radius, EHitZone& Zone) const;
+
+	/**
+	 * Damage dealt to Target by a shot that reached its collision, scaled by the body part hit.
+	 * Targets without proxies take the full Damage, a shot passing between up to date proxies deals none.
+	 */
+	static float ComputeDamage(const AActor* Target, float Damage, const FHitZoneDamage& ZoneDamage,
+		const FVector& Origin, const FVector& Direction, float Radius = 0.0f);
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPROPERTY(Transient)
+	USkinnedMeshComponent* Mesh;
+
+	/** Proxies whose bones exist in the skeleton, the others are dropped in BeginPlay */
+	TArray<int32> StartBones;
+	TArray<int32> EndBones;
+	TArray<float> Radii;
+	TArray<EHitZone> Zones;
+
+	/** Proxy segments in actor space, written by Refresh */
+	TArray<FVector> Starts;
+	TArray<FVector> Ends;
+
+	/** Radius of the sphere, in actor space, holding all the proxies */
+	float BoundsRadius = 0.0f;
+
+	/** Pose frame of the mesh at the last refresh, and whether it had ticked since the one before */
+	uint32 RefreshedPoseFrame = 0;
+	bool bStalePose = false;
+
+	FTimerHandle RefreshTimer;
+
+	void Refresh();
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LatentActionSubsystem.h"
+
+#include "FixedStepSubsystem.h"
+
+void FLatentAction::Init(UObject* InOwner) {
+	Owner = InOwner;
+}
+
+void FLatentAction::Start(float InPeriod, int32 InSteps, float FirstDelay) {
+	UWorld* World = Owner.IsValid() ? Owner->GetWorld() : nullptr;
+	ULatentActionSubsystem* Scheduler = World ? World->GetSubsystem<ULatentActionSubsystem>() : nullptr;
+	if (!Scheduler) {
+		return;
+	}
+
+	Cancel();
+
+	// An endless sequence with no period would never leave the frame
+	Period = InSteps == 0 ? FMath::Max(InPeriod, KINDA_SMALL_NUMBER) : InPeriod;
+	StepsLeft = InSteps;
+	bRunning = true;
+	Serial++;
+	Scheduler->Schedule(*this, FirstDelay < 0.0f ? Period : FirstDelay);
+}
+
+void FLatentAction::Await(FLatentAction& InPrerequisite, float InPeriod, int32 InSteps, float FirstDelay) {
+	if (!InPrerequisite.IsRunning()) {
+		Start(InPeriod, InSteps, FirstDelay);
+		return;
+	}
+
+	Cancel();
+
+	if (InPrerequisite.Waiter) {
+		InPrerequisite.Waiter->Prerequisite = nullptr;
+	}
+	InPrerequisite.Waiter = this;
+	Prerequisite = &InPrerequisite;
+	Period = InPeriod;
+	StepsLeft = InSteps;
+	PendingDelay = FirstDelay;
+}
+
+void FLatentAction::Cancel() {
+	if (Prerequisite) {
+		Prerequisite->Waiter = nullptr;
+		Prerequisite = nullptr;
+	}
+
+	if (bRunning) {
+		Finish(true);
+	}
+}
+
+void FLatentAction::Complete() {
+	if (bRunning) {
+		Finish(false);
+	}
+}
+
+void FLatentAction::Finish(bool bCancelled) {
+	bRunning = false;
+	Serial++;
+
+	FLatentAction* Next = Waiter;
+	if (Next) {
+		Next->Prerequisite = nullptr;
+		Waiter = nullptr;
+	}
+
+	OnFinished.ExecuteIfBound(bCancelled);
+
+	if (Next && !bCancelled) {
+		Next->Start(Next->Period, Next->StepsLeft, Next->PendingDelay);
+	}
+}
+
+void ULatentActionSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	// The sequences are gameplay, they follow the simulation steps when there are some
+	UFixedStepSubsystem* FixedStep = InWorld.GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStep && FixedStep->IsEnabled()) {
+		FixedStepHandle = FixedStep->OnFixedStep().AddUObject(this, &ULatentActionSubsystem::Advance);
+	}
+}
+
+void ULatentActionSubsystem::Deinitialize() {
+	if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>()) {
+		FixedStep->OnFixedStep().Remove(FixedStepHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId ULatentActionSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULatentActionSubsystem, STATGROUP_Tickables);
+}
+
+bool ULatentActionSubsystem::IsTickable() const {
+	return !FixedStepHandle.IsValid() && Wakes.Num() > 0;
+}
+
+void ULatentActionSubsystem::Tick(float DeltaTime) {
+	Advance(DeltaTime);
+}
+
+void ULatentActionSubsystem::Schedule(FLatentAction& Action, float Delay) {
+	Wakes.HeapPush({Now + Delay, &Action, Action.Owner, Action.Serial}, FWakeOrder());
+}
+
+void ULatentActionSubsystem::Advance(float DeltaTime) {
+	Now += DeltaTime;
+
+	while (Wakes.Num() > 0 && Wakes.HeapTop().Time <= Now) {
+		FWake Wake;
+		Wakes.HeapPop(Wake, FWakeOrder(), false);
+
+		// Restarted, cancelled, or its owner is gone
+		if (!Wake.Owner.IsValid() || Wake.Serial != Wake.Action->Serial) {
+			continue;
+		}
+
+		FLatentAction& Action = *Wake.Action;
+		bool bContinue = !Action.OnStep.IsBound() || Action.OnStep.Execute();
+
+		// The step itself may have cancelled or restarted the sequence
+		if (Wake.Serial != Action.Serial) {
+			continue;
+		}
+
+		if (!bContinue || (Action.StepsLeft > 0 && --Action.StepsLeft == 0)) {
+			Action.Finish(false);
+		} else {
+			// From the wake time, not from Now, so a late frame doesn't stretch the cadence
+			Wakes.HeapPush({Wake.Time + Action.Period, &Action, Wake.Owner, Wake.Serial}, FWakeOrder());
+		}
+	}
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LatentActionSubsystem.generated.h"
+
+/** Called at each step of a sequence, false ends it early */
+DECLARE_DELEGATE_RetVal(bool, FLatentStepDelegate);
+
+/** Called when a sequence ends, bCancelled if stopped by Cancel */
+DECLARE_DELEGATE_OneParam(FLatentFinishedDelegate, bool /* bCancelled */);
+
+/**
+ * Timed gameplay sequence embedded in its owner: OnStep runs every Period, for Steps steps or until it
+ * returns false, then OnFinished runs. Bind the delegates once after Init, starting, cancelling and
+ * awaiting a sequence allocates nothing afterwards. The wakes are scheduled by ULatentActionSubsystem,
+ * nothing polls the sequences while they wait.
+ */
+struct UE_TPSPROJECT_API FLatentAction
+{
+	FLatentStepDelegate OnStep;
+
+	FLatentFinishedDelegate OnFinished;
+
+	/** The sequence never wakes once Owner is destroyed */
+	void Init(UObject* InOwner);
+
+	/**
+	 * Start over, cancelling the current run.
+	 * @param InSteps		Steps to run, 0 runs until cancelled or until OnStep returns false
+	 * @param FirstDelay	Delay of the first step, Period if negative
+	 */
+	void Start(float InPeriod, int32 InSteps = 1, float FirstDelay = -1.0f);
+
+	/** Start once Prerequisite finishes, never if it is cancelled. A sequence has one waiter at most */
+	void Await(FLatentAction& Prerequisite, float InPeriod, int32 InSteps = 1, float FirstDelay = -1.0f);
+
+	/** Stop the run and call OnFinished with bCancelled, or drop the pending Await */
+	void Cancel();
+
+	/** End the run now as if its last step ran, the waiter starts */
+	void Complete();
+
+	bool IsRunning() const { return bRunning; }
+
+	bool IsWaiting() const { return Prerequisite != nullptr; }
+
+private:
+	friend class ULatentActionSubsystem;
+
+	TWeakObjectPtr<UObject> Owner;
+
+	float Period = 0.0f;
+
+	float PendingDelay = -1.0f;
+
+	int32 StepsLeft = 0;
+
+	/** Bumped on every start and stop, the wakes scheduled before are ignored */
+	uint32 Serial = 0;
+
+	bool bRunning = false;
+
+	FLatentAction* Prerequisite = nullptr;
+
+	FLatentAction* Waiter = nullptr;
+
+	void Finish(bool bCancelled);
+};
+
+/**
+ * Wakes the FLatentAction sequences of the world from a heap ordered by wake time, so a frame only
+ * looks at the sequences that are due. Runs on the simulation steps when UFixedStepSubsystem is enabled.
+ */
+UCLASS()
+class UE_TPSPROJECT_API ULatentActionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+	void Schedule(FLatentAction& Action, float Delay);
+
+private:
+	struct FWake
+	{
+		double Time;
+		FLatentAction* Action;
+		/** Checked before touching Action, which lives in the owner */
+		TWeakObjectPtr<UObject> Owner;
+		uint32 Serial;
+	};
+
+	/** Earliest wake on top of the heap */
+	struct FWakeOrder
+	{
+		bool operator()(const FWake& A, const FWake& B) const { return A.Time < B.Time; }
+	};
+
+	/** Binary heap on Time */
+	TArray<FWake> Wakes;
+
+	/** Sequence clock, advanced by Tick or by the fixed steps */
+	double Now = 0.0;
+
+	FDelegateHandle FixedStepHandle;
+
+	void Advance(float DeltaTime);
+};
@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MissionSaveSubsystem.h"
+
+#include "Enemy.h"
+#include "EnemyAIController.h"
+#include "EnemyPath.h"
+#include "HealthComponent.h"
+#include "UE_TPSProjectCharacter.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static FAutoConsoleCommandWithWorldAndArgs SaveMissionCommand(
+	TEXT("TPS.SaveMission"),
+	TEXT("Save the mission state. Usage: TPS.SaveMission <slot>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		UMissionSaveSubsystem* Saves = World ? World->GetSubsystem<UMissionSaveSubsystem>() : nullptr;
+		if (Saves && Args.Num() > 0) {
+			Saves->SaveMission(Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs LoadMissionCommand(
+	TEXT("TPS.LoadMission"),
+	TEXT("Restore the mission state. Usage: TPS.LoadMission <slot>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		UMissionSaveSubsystem* Saves = World ? World->GetSubsystem<UMissionSaveSubsystem>() : nullptr;
+		if (Saves && Args.Num() > 0) {
+			Saves->LoadMission(Args[0]);
+		}
+	}));
+
+/** Records are plain data, the whole array is copied at once */
+template <typename RecordType>
+static void SerializeRecords(FArchive& Ar, TArray<RecordType>& Records) {
+	int32 Num = Records.Num();
+	Ar << Num;
+
+	if (Ar.IsLoading()) {
+		if (Num < 0 || static_cast<int64>(Num) * sizeof(RecordType) > Ar.TotalSize() - Ar.Tell()) {
+			Ar.SetError();
+			return;
+		}
+		Records.SetNumUninitialized(Num);
+	}
+	Ar.Serialize(Records.GetData(), Num * sizeof(RecordType));
+}
+
+TStatId UMissionSaveSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMissionSaveSubsystem, STATGROUP_Tickables);
+}
+
+bool UMissionSaveSubsystem::IsTickable() const {
+	return PendingLoad.IsValid();
+}
+
+void UMissionSaveSubsystem::Deinitialize() {
+	// A save in flight must reach the disk, a load has nothing left to apply to
+	PendingSave.Wait();
+	PendingLoad.Wait();
+	Super::Deinitialize();
+}
+
+void UMissionSaveSubsystem::Tick(float DeltaTime) {
+	if (!PendingLoad.IsCompleted()) {
+		return;
+	}
+
+	FMissionSnapshot Snapshot = MoveTemp(PendingLoad.GetResult());
+	PendingLoad = {};
+
+	if (Snapshot.bValid) {
+		ApplySnapshot(Snapshot);
+	}
+}
+
+FString UMissionSaveSubsystem::GetSlotPath(const FString& Slot) {
+	return FPaths::ProjectSavedDir() / TEXT("Missions") / Slot + TEXT(".sav");
+}
+
+uint32 UMissionSaveSubsystem::ActorId(const AActor* Actor) {
+	// Without the PIE prefix, a save made in the editor loads in a packaged game
+	return FCrc::StrCrc32(*UWorld::RemovePIEPrefix(Actor->GetPathName()));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Game thread
+
+void UMissionSaveSubsystem::SaveMission(const FString& Slot) {
+	FMissionSnapshot Snapshot;
+	{
+		// The only part of a save paid by the game thread
+		QUICK_SCOPE_CYCLE_COUNTER(STAT_MissionSave_Snapshot);
+		TakeSnapshot(Snapshot);
+	}
+
+	// Chained to the previous save so two saves of the same slot never write at the same time
+	PendingSave = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Path = GetSlotPath(Slot), Snapshot = MoveTemp(Snapshot)]() mutable {
+			if (!WriteSave(Path, Snapshot)) {
+				UE_LOG(LogTemp, Warning, TEXT("Cannot write the mission save %s"), *Path);
+			}
+		},
+		UE::Tasks::Prerequisites(PendingSave));
+}
+
+void UMissionSaveSubsystem::LoadMission(const FString& Slot) {
+	if (PendingLoad.IsValid()) {
+		return;
+	}
+
+	PendingLoad = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Path = GetSlotPath(Slot)]() {
+			return ReadSave(Path);
+		},
+		UE::Tasks::Prerequisites(PendingSave));
+}
+
+void UMissionSaveSubsystem::TakeSnapshot(FMissionSnapshot& Snapshot) const {
+	Snapshot.bValid = true;
+
+	AUE_TPSProjectCharacter* Player = Cast<AUE_TPSProjectCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+	if (IsValid(Player)) {
+		Snapshot.bHasPlayer = true;
+		Snapshot.Player.Location = FVector3f(Player->GetActorLocation());
+		Snapshot.Player.Yaw = Player->GetActorRotation().Yaw;
+		Snapshot.Player.Health = Player->GetHealthComponent()->Health;
+		Snapshot.Player.MaxHealth = Player->GetHealthComponent()->GetMaxHealth();
+		Snapshot.Player.ActiveWeapon = Player->GetActiveWeaponIndex();
+		Snapshot.Player.MagBullets = Player->MagCounter();
+
+		for (const FThrowableSlot& Throwable : Player->Throwables) {
+			Snapshot.ThrowableCounts.Add(Throwable.Count);
+		}
+	}
+
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It) {
+		AEnemy* Enemy = *It;
+		const UHealthComponent* Health = Enemy->GetHealthComponent();
+		const AEnemyAIController* Controller = Cast<AEnemyAIController>(Enemy->GetController());
+
+		FEnemyRecord& Record = Snapshot.Enemies.AddDefaulted_GetRef();
+		Record.Id = ActorId(Enemy);
+		Record.Location = FVector3f(Enemy->GetActorLocation());
+		Record.Yaw = Enemy->GetActorRotation().Yaw;
+		Record.Health = Health->Health;
+		Record.MaxHealth = Health->GetMaxHealth();
+		Record.Flags = 0;
+		if (Health->Health <= 0) {
+			Record.Flags |= EnemyDead;
+		}
+		if (Controller && Controller->IsAlerted()) {
+			Record.Flags |= EnemyAlerted;
+		}
+	}
+
+	for (TActorIterator<AEnemyPath> It(GetWorld()); It; ++It) {
+		Snapshot.Paths.Add({ActorId(*It), It->GetPathIndex(), It->GetPathSense()});
+	}
+}
+
+void UMissionSaveSubsystem::ApplySnapshot(const FMissionSnapshot& Snapshot) {
+	AUE_TPSProjectCharacter* Player = Cast<AUE_TPSProjectCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+
+	if (IsValid(Player) && Snapshot.bHasPlayer) {
+		Player->SetActorLocationAndRotation(FVector(Snapshot.Player.Location), FRotator(0.0f, Snapshot.Player.Yaw, 0.0f), false, nullptr, ETeleportType::TeleportPhysics);
+		Player->GetHealthComponent()->RestoreHealth(Snapshot.Player.Health, Snapshot.Player.MaxHealth);
+		Player->RestoreWeaponState(Snapshot.Player.ActiveWeapon, Snapshot.Player.MagBullets);
+
+		for (int32 Index = 0; Index < FMath::Min(Player->Throwables.Num(), Snapshot.ThrowableCounts.Num()); Index++) {
+			Player->Throwables[Index].Count = Snapshot.ThrowableCounts[Index];
+		}
+	}
+
+	// Index the saved records once, then visit every placed actor once
+	TMap<uint32, int32> EnemyRecords;
+	EnemyRecords.Reserve(Snapshot.Enemies.Num());
+	for (int32 Index = 0; Index < Snapshot.Enemies.Num(); Index++) {
+		EnemyRecords.Add(Snapshot.Enemies[Index].Id, Index);
+	}
+
+	for (TActorIterator<AEnemy> It(GetWorld()); It; ++It) {
+		AEnemy* Enemy = *It;
+		const int32* Index = EnemyRecords.Find(ActorId(Enemy));
+		if (!Index) {
+			continue;
+		}
+
+		// Dead in the save and in the world, its death logic already ran
+		const FEnemyRecord& Record = Snapshot.Enemies[*Index];
+		bool bDead = Enemy->GetHealthComponent()->Health <= 0;
+		if (bDead && (Record.Flags & EnemyDead)) {
+			continue;
+		}
+
+		Enemy->SetActorLocationAndRotation(FVector(Record.Location), FRotator(0.0f, Record.Yaw, 0.0f), false, nullptr, ETeleportType::TeleportPhysics);
+
+		// Killed after the save, before its controller is looked up
+		if (bDead) {
+			Enemy->Revive();
+		}
+
+		AEnemyAIController* Controller = Cast<AEnemyAIController>(Enemy->GetController());
+		if (Controller && (Record.Flags & EnemyAlerted) && !(Record.Flags & EnemyDead)) {
+			// The save doesn't keep the alert age, a loaded alert starts fresh
+			Controller->RestoreAlert(Player, 0.0f);
+		}
+
+		// Last, a dead enemy runs its death logic from the HealthZero event
+		Enemy->GetHealthComponent()->RestoreHealth((Record.Flags & EnemyDead) ? 0.0f : Record.Health, Record.MaxHealth);
+	}
+
+	TMap<uint32, const FPathRecord*> PathRecords;
+	PathRecords.Reserve(Snapshot.Paths.Num());
+	for (const FPathRecord& Record : Snapshot.Paths) {
+		PathRecords.Add(Record.Id, &Record);
+	}
+
+	for (TActorIterator<AEnemyPath> It(GetWorld()); It; ++It) {
+		if (const FPathRecord* const* Record = PathRecords.Find(ActorId(*It))) {
+			It->RestoreCursor((*Record)->PathIndex, (*Record)->PathSense);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Worker threads
+
+void UMissionSaveSubsystem::SerializeSnapshot(FArchive& Ar, FMissionSnapshot& Snapshot) {
+	Ar << Snapshot.bHasPlayer;
+	Ar.Serialize(&Snapshot.Player, sizeof(Snapshot.Player));
+	Ar << Snapshot.ThrowableCounts;
+	SerializeRecords(Ar, Snapshot.Enemies);
+	SerializeRecords(Ar, Snapshot.Paths);
+}
+
+bool UMissionSaveSubsystem::WriteSave(const FString& Path, FMissionSnapshot& Snapshot) {
+	TArray<uint8> Body;
+	FMemoryWriter BodyWriter(Body);
+	SerializeSnapshot(BodyWriter, Snapshot);
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, Body.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Oodle, Compressed.GetData(), CompressedSize, Body.GetData(), Body.Num())) {
+		return false;
+	}
+	Compressed.SetNum(CompressedSize, false);
+
+	uint32 Magic = SaveMagic;
+	uint16 Version = SaveVersion;
+	int32 UncompressedSize = Body.Num();
+
+	TArray<uint8> File;
+	FMemoryWriter FileWriter(File);
+	FileWriter << Magic << Version << UncompressedSize << CompressedSize;
+	FileWriter.Serialize(Compressed.GetData(), CompressedSize);
+
+	// Written next to the slot and moved over it, a crash while writing keeps the previous save
+	FString TempPath = Path + TEXT(".tmp");
+	return FFileHelper::SaveArrayToFile(File, *TempPath) && IFileManager::Get().Move(*Path, *TempPath);
+}
+
+UMissionSaveSubsystem::FMissionSnapshot UMissionSaveSubsystem::ReadSave(const FString& Path) {
+	FMissionSnapshot Snapshot;
+
+	TArray<uint8> File;
+	if (!FFileHelper::LoadFileToArray(File, *Path)) {
+		UE_LOG(LogTemp, Warning, TEXT("Cannot read the mission save %s"), *Path);
+		return Snapshot;
+	}
+
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	int32 UncompressedSize = 0;
+	int32 CompressedSize = 0;
+
+	FMemoryReader FileReader(File);
+	FileReader << Magic << Version << UncompressedSize << CompressedSize;
+	if (FileReader.IsError() || Magic != SaveMagic || Version != SaveVersion || UncompressedSize < 0
+		|| CompressedSize != File.Num() - FileReader.Tell()) {
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a supported mission save"), *Path);
+		return Snapshot;
+	}
+
+	TArray<uint8> Body;
+	Body.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(NAME_Oodle, Body.GetData(), UncompressedSize, File.GetData() + FileReader.Tell(), CompressedSize)) {
+		UE_LOG(LogTemp, Warning, TEXT("The mission save %s is corrupted"), *Path);
+		return Snapshot;
+	}
+
+	FMemoryReader BodyReader(Body);
+	SerializeSnapshot(BodyReader, Snapshot);
+	Snapshot.bValid = !BodyReader.IsError();
+	return Snapshot;
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "MissionSaveSubsystem.generated.h"
+
+/**
+ * Saves and restores the mid-mission state: health, weapon state, enemy alert and death state,
+ * patrol cursors. An enemy killed after the save is revived with a new controller. The player has a
+ * single magazine, for the active weapon: the other slots of the arsenal hold no ammo state to save.
+ * The game thread only copies the state in flat arrays of fixed records. Serialization,
+ * compression and file access run on worker tasks. A loaded save is applied to the placed actors
+ * in a single pass on the game thread, nothing is spawned.
+ * Console: TPS.SaveMission <slot>, TPS.LoadMission <slot>.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UMissionSaveSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Snapshot the mission and write it in the background */
+	void SaveMission(const FString& Slot);
+
+	/** Read the save in the background, it is applied on the first tick after the read completes */
+	void LoadMission(const FString& Slot);
+
+	static FString GetSlotPath(const FString& Slot);
+
+private:
+	static constexpr uint32 SaveMagic = 0x4D535054; // "TPSM"
+	// 2: actor ids hash the actor path instead of its name
+	static constexpr uint16 SaveVersion = 2;
+
+	struct FPlayerRecord
+	{
+		FVector3f Location;
+		float Yaw;
+		float Health;
+		float MaxHealth;
+		int32 ActiveWeapon;
+		int32 MagBullets;
+	};
+
+	enum EEnemyFlags : uint8
+	{
+		EnemyDead = 1 << 0,
+		EnemyAlerted = 1 << 1
+	};
+
+	/** Placed actors are identified by the hash of their name, stable between runs */
+	struct FEnemyRecord
+	{
+		uint32 Id;
+		FVector3f Location;
+		float Yaw;
+		float Health;
+		float MaxHealth;
+		uint8 Flags;
+	};
+
+	struct FPathRecord
+	{
+		uint32 Id;
+		int32 PathIndex;
+		int32 PathSense;
+	};
+
+	struct FMissionSnapshot
+	{
+		bool bValid = false;
+		bool bHasPlayer = false;
+		FPlayerRecord Player = {};
+		TArray<int32> ThrowableCounts;
+		TArray<FEnemyRecord> Enemies;
+		TArray<FPathRecord> Paths;
+	};
+
+	/** Last save still being compressed or written, the next save waits for it */
+	UE::Tasks::FTask PendingSave;
+
+	UE::Tasks::TTask<FMissionSnapshot> PendingLoad;
+
+	void TakeSnapshot(FMissionSnapshot& Snapshot) const;
+
+	void ApplySnapshot(const FMissionSnapshot& Snapshot);
+
+	/** Hash of the level package and actor name, the same name can be placed in two streaming levels */
+	static uint32 ActorId(const AActor* Actor);
+
+	/** Serialize and compress, runs on a worker thread */
+	static bool WriteSave(const FString& Path, FMissionSnapshot& Snapshot);
+
+	/** Read and decompress, runs on a worker thread */
+	static FMissionSnapshot ReadSave(const FString& Path);
+
+	static void SerializeSnapshot(FArchive& Ar, FMissionSnapshot& Snapshot);
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileSubsystem.h"
+
+#include "UE_TPSProject.h"
+#include "CollisionReport.h"
+#include "CombatTelemetry.h"
+#include "Enemy.h"
+#include "FixedStepSubsystem.h"
+#include "HealthComponent.h"
+#include "HitboxComponent.h"
+#include "PropHealthSubsystem.h"
+#include "UE_TPSProjectCharacter.h"
+#include "Kismet/GameplayStatics.h"
+#include "Math/VectorRegister.h"
+
+void UProjectileSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	// The rounds deal damage, they advance with the rest of the combat simulation
+	UFixedStepSubsystem* FixedStep = InWorld.GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStep && FixedStep->IsEnabled()) {
+		FixedStepHandle = FixedStep->OnFixedStep().AddUObject(this, &UProjectileSubsystem::Step);
+	}
+}
+
+void UProjectileSubsystem::Deinitialize() {
+	if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>()) {
+		FixedStep->OnFixedStep().Remove(FixedStepHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+TStatId UProjectileSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+bool UProjectileSubsystem::IsTickable() const {
+	return !FixedStepHandle.IsValid() && Count > 0;
+}
+
+void UProjectileSubsystem::FireProjectile(AActor* Shooter, const FVector& Start, const FVector& Direction, const FWeaponSlot& Weapon) {
+	// Grow the hot arrays by a whole register so the integration never needs a scalar tail
+	if (Count == PositionX.Num()) {
+		for (TArray<float>* Hot : {&PositionX, &PositionY, &PositionZ, &VelocityX, &VelocityY, &VelocityZ, &GravityZ, &TimeLeft}) {
+			Hot->AddZeroed(4);
+		}
+	}
+
+	FVector Velocity = Direction.GetSafeNormal() * Weapon.MuzzleVelocity;
+
+	PositionX[Count] = Start.X;
+	PositionY[Count] = Start.Y;
+	PositionZ[Count] = Start.Z;
+	VelocityX[Count] = Velocity.X;
+	VelocityY[Count] = Velocity.Y;
+	VelocityZ[Count] = Velocity.Z;
+	GravityZ[Count] = GetWorld()->GetGravityZ() * Weapon.ProjectileGravityScale;
+	TimeLeft[Count] = Weapon.Range / FMath::Max(Weapon.MuzzleVelocity, 1.0f);
+
+	Damage.Add(Weapon.Damage);
+	ZoneDamage.Add(Weapon.ZoneDamage);
+	Shooters.Add(Shooter);
+	FromEnemy.Add(Shooter && Shooter->IsA<AEnemy>());
+	HitEffects.Add(Weapon.HitEFX);
+
+	Count++;
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime) {
+	Step(DeltaTime);
+}
+
+void UProjectileSubsystem::Step(float DeltaTime) {
+	if (Count == 0) {
+		return;
+	}
+
+	Integrate(DeltaTime);
+
+	// Walk backward so a removal only moves rounds already processed
+	for (int32 Index = Count - 1; Index >= 0; Index--) {
+		if (!TraceSegment(Index, DeltaTime)) {
+			RemoveProjectile(Index);
+		}
+	}
+}
+
+void UProjectileSubsystem::Integrate(float DeltaTime) {
+	const VectorRegister4Float DeltaTimeVector = VectorSetFloat1(DeltaTime);
+	const int32 NumPadded = Align(Count, 4);
+
+	// Semi-implicit Euler: gravity first, then positions with the new velocity
+	for (int32 Index = 0; Index < NumPadded; Index += 4) {
+		VectorRegister4Float VelZ = VectorMultiplyAdd(VectorLoad(&GravityZ[Index]), DeltaTimeVector, VectorLoad(&VelocityZ[Index]));
+		VectorStore(VelZ, &VelocityZ[Index]);
+
+		VectorStore(VectorMultiplyAdd(VectorLoad(&VelocityX[Index]), DeltaTimeVector, VectorLoad(&PositionX[Index])), &PositionX[Index]);
+		VectorStore(VectorMultiplyAdd(VectorLoad(&VelocityY[Index]), DeltaTimeVector, VectorLoad(&PositionY[Index])), &PositionY[Index]);
+		VectorStore(VectorMultiplyAdd(VelZ, DeltaTimeVector, VectorLoad(&PositionZ[Index])), &PositionZ[Index]);
+		VectorStore(VectorSubtract(VectorLoad(&TimeLeft[Index]), DeltaTimeVector), &TimeLeft[Index]);
+	}
+}
+
+bool UProjectileSubsystem::TraceSegment(int32 Index, float DeltaTime) {
+	FVector End(PositionX[Index], PositionY[Index], PositionZ[Index]);
+	FVector Velocity(VelocityX[Index], VelocityY[Index], VelocityZ[Index]);
+	// The step start is recovered from the velocity instead of keeping the previous positions
+	FVector Start = End - Velocity * DeltaTime;
+
+	FCollisionQueryParams Params;
+	AActor* Shooter = Shooters[Index].Get();
+	if (Shooter) {
+		Params.AddIgnoredActor(Shooter);
+	}
+
+	FHitResult Hit;
+	bool bHit;
+	{
+		// Charged to the weapon owner, the subsystem itself when it is gone
+		SCOPE_COLLISION_QUERY(Shooter ? static_cast<const UObject*>(Shooter) : this);
+		bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Weapon, Params);
+	}
+	if (!bHit) {
+		return TimeLeft[Index] > 0.0f;
+	}
+
+	if (ShouldPlayCosmetics(GetWorld())) {
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitEffects[Index], Hit.ImpactPoint);
+	}
+
+	// Same rules as the hitscan paths: enemies hurt the player, the player hurts enemies
+	AActor* HitActor = Hit.GetActor();
+	bool bCanDamage = HitActor && (FromEnemy[Index] ? HitActor->IsA<AUE_TPSProjectCharacter>() : HitActor->IsA<AEnemy>());
+
+	if (bCanDamage && HitActor->HasAuthority()) {
+		UHealthComponent* Health = HitActor->FindComponentByClass<UHealthComponent>();
+		float HitDamage = UHitboxComponent::ComputeDamage(HitActor, Damage[Index], ZoneDamage[Index], Start, Velocity);
+		if (Health && HitDamage > 0.0f) {
+			FCombatTelemetry::Record(CombatTelemetry::ERecordType::Hit, Shooter, HitActor);
+			Health->GetDamage(HitDamage);
+		}
+	} else if (!HitActor || !HitActor->IsA<ACharacter>()) {
+		UPropHealthSubsystem::DamageHit(Hit, Damage[Index]);
+	}
+
+	return false;
+}
+
+void UProjectileSubsystem::RemoveProjectile(int32 Index) {
+	const int32 Last = Count - 1;
+
+	// Move the last round in the hole and clear its old slot, the padding must stay zeroed
+	for (TArray<float>* Hot : {&PositionX, &PositionY, &PositionZ, &VelocityX, &VelocityY, &VelocityZ, &GravityZ, &TimeLeft}) {
+		(*Hot)[Index] = (*Hot)[Last];
+		(*Hot)[Last] = 0.0f;
+	}
+
+	Damage.RemoveAtSwap(Index, 1, false);
+	ZoneDamage.RemoveAtSwap(Index, 1, false);
+	Shooters.RemoveAtSwap(Index, 1, false);
+	FromEnemy.RemoveAtSwap(Index, 1, false);
+	HitEffects.RemoveAtSwap(Index, 1, false);
+
+	Count--;
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FWeaponSlot.h"
+#include "ProjectileSubsystem.generated.h"
+
+/**
+ * Simulates the rounds of projectile mode weapons without spawning actors.
+ * In-flight rounds are stored as struct of arrays, padded to a multiple of 4 so the integration
+ * runs on whole SIMD registers. After each step the travelled segments are traced in one pass and
+ * hits go through UHealthComponent::GetDamage. Only ticks while rounds are in flight, and not at all
+ * when UFixedStepSubsystem is enabled: the rounds then advance on the simulation steps.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Launch a round of Weapon from Start along Direction */
+	void FireProjectile(AActor* Shooter, const FVector& Start, const FVector& Direction, const FWeaponSlot& Weapon);
+
+	int32 NumProjectiles() const { return Count; }
+
+private:
+	int32 Count = 0;
+
+	// Hot data, integrated every step
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> GravityZ;
+	TArray<float> TimeLeft;
+
+	// Cold data, read on hit only
+	TArray<float> Damage;
+	TArray<FHitZoneDamage> ZoneDamage;
+	TArray<TWeakObjectPtr<AActor>> Shooters;
+	TArray<bool> FromEnemy;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystem*> HitEffects;
+
+	FDelegateHandle FixedStepHandle;
+
+	/** Integrate and trace every round over DeltaTime, run by the tick or by UFixedStepSubsystem */
+	void Step(float DeltaTime);
+
+	/** Advance every round by DeltaTime */
+	void Integrate(float DeltaTime);
+
+	/** Trace the segments of the last step, return false if the round must be removed */
+	bool TraceSegment(int32 Index, float DeltaTime);
+
+	void RemoveProjectile(int32 Index);
+};
@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PropHealthSubsystem.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/HitResult.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+
+void UPropHealthSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UPropHealthSubsystem::OnLevelRemoved);
+}
+
+void UPropHealthSubsystem::Deinitialize() {
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::Deinitialize();
+}
+
+void UPropHealthSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World) {
+	if (World != GetWorld()) {
+		return;
+	}
+
+	// A null level is the whole world going away
+	for (auto It = MaxHealths.CreateIterator(); It; ++It) {
+		const UPrimitiveComponent* Component = It.Key().Get();
+		if (!Component || !Level || Component->GetComponentLevel() == Level) {
+			It.RemoveCurrent();
+		}
+	}
+}
+
+TStatId UPropHealthSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPropHealthSubsystem, STATGROUP_Tickables);
+}
+
+bool UPropHealthSubsystem::IsTickable() const {
+	return Destroyed.Num() > 0 || (RegenRate > 0.0f && Props.Num() > NumDestroyed);
+}
+
+void UPropHealthSubsystem::Tick(float DeltaTime) {
+	if (Destroyed.Num() > 0) {
+		if (bHideDestroyed) {
+			HideDestroyed();
+		}
+		PropsDestroyed.Broadcast(Destroyed);
+		Destroyed.Reset();
+	}
+
+	if (RegenRate > 0.0f && Props.Num() > NumDestroyed) {
+		RegenClock += DeltaTime;
+		if (RegenClock >= RegenInterval) {
+			Regenerate(RegenClock);
+			RegenClock = 0.0f;
+		}
+	}
+}
+
+bool UPropHealthSubsystem::DamageHit(const FHitResult& Hit, float Amount) {
+	UPrimitiveComponent* Component = Hit.GetComponent();
+	UPropHealthSubsystem* Props = Component ? Component->GetWorld()->GetSubsystem<UPropHealthSubsystem>() : nullptr;
+	if (!Props) {
+		return false;
+	}
+
+	// Item is the hit instance on the instanced static meshes
+	int32 Instance = Component->IsA<UInstancedStaticMeshComponent>() ? Hit.Item : INDEX_NONE;
+	return Props->ApplyDamage(Component, Instance, Amount);
+}
+
+bool UPropHealthSubsystem::ApplyDamage(UPrimitiveComponent* Component, int32 Instance, float Amount) {
+	if (!Component || Amount <= 0.0f) {
+		return false;
+	}
+
+	float MaxHealth = GetMaxHealth(Component);
+	if (MaxHealth <= 0.0f) {
+		return false;
+	}
+
+	FPropRef Ref{Component, Instance};
+	FPropHealth& Prop = Props.FindOrAdd(Ref);
+	if (Prop.Health <= 0.0f) {
+		return false;
+	}
+
+	Prop.Health -= Amount / MaxHealth;
+	Prop.LastDamageTime = GetWorld()->GetTimeSeconds();
+
+	if (Prop.Health <= 0.0f) {
+		Prop.Health = 0.0f;
+		NumDestroyed++;
+		Destroyed.Add(Ref);
+	}
+	return true;
+}
+
+float UPropHealthSubsystem::GetHealthFraction(UPrimitiveComponent* Component, int32 Instance) const {
+	const FPropHealth* Prop = Props.Find({Component, Instance});
+	return Prop ? Prop->Health : 1.0f;
+}
+
+float UPropHealthSubsystem::GetMaxHealth(const UPrimitiveComponent* Component) {
+	// Every primitive hit or caught by an explosion is cached, destructible or not, the tags are parsed once
+	if (const float* Cached = MaxHealths.Find(Component)) {
+		return *Cached;
+	}
+	return MaxHealths.Add(Component, ReadMaxHealth(Component));
+}
+
+float UPropHealthSubsystem::ReadMaxHealth(const UPrimitiveComponent* Component) const {
+	static const FName DestructibleTag(TEXT("Destructible"));
+
+	auto ReadTags = [this](const TArray<FName>& Tags) {
+		for (const FName& Tag : Tags) {
+			if (Tag == DestructibleTag) {
+				return DefaultMaxHealth;
+			}
+
+			float MaxHealth = 0.0f;
+			if (FParse::Value(*Tag.ToString(), TEXT("PropHealth="), MaxHealth)) {
+				return MaxHealth;
+			}
+		}
+		return 0.0f;
+	};
+
+	float MaxHealth = ReadTags(Component->ComponentTags);
+	if (MaxHealth <= 0.0f && Component->GetOwner()) {
+		MaxHealth = ReadTags(Component->GetOwner()->Tags);
+	}
+	return MaxHealth;
+}
+
+FVector UPropHealthSubsystem::GetPropLocation(const UPrimitiveComponent* Component, int32 Instance) {
+	const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component);
+	FTransform Transform;
+	if (Instanced && Instanced->GetInstanceTransform(Instance, Transform, true)) {
+		return Transform.GetLocation();
+	}
+	return Component->GetComponentLocation();
+}
+
+void UPropHealthSubsystem::Regenerate(float DeltaTime) {
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (auto It = Props.CreateIterator(); It; ++It) {
+		FPropHealth& Prop = It.Value();
+
+		// Streamed out with its level
+		if (!It.Key().Component.IsValid()) {
+			NumDestroyed -= Prop.Health <= 0.0f ? 1 : 0;
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Prop.Health <= 0.0f || Now - Prop.LastDamageTime < RegenDelay) {
+			continue;
+		}
+
+		// Back to full health the prop leaves the store and costs nothing again
+		Prop.Health += RegenRate * DeltaTime;
+		if (Prop.Health >= 1.0f) {
+			Restored.Add(It.Key());
+			It.RemoveCurrent();
+		}
+	}
+
+	if (Restored.Num() > 0) {
+		PropsRestored.Broadcast(Restored);
+		Restored.Reset();
+	}
+}
+
+void UPropHealthSubsystem::HideDestroyed() {
+	TArray<UInstancedStaticMeshComponent*, TInlineAllocator<8>> DirtyInstanced;
+
+	for (const FPropRef& Ref : Destroyed) {
+		UPrimitiveComponent* Component = Ref.Component.Get();
+		if (!Component) {
+			continue;
+		}
+
+		UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component);
+		FTransform Transform;
+		if (Instanced && Instanced->GetInstanceTransform(Ref.Instance, Transform)) {
+			// Removing the instance would shift the indices the store is keyed on, a zero scale
+			// hides it and drops its body instead
+			Transform.SetScale3D(FVector::ZeroVector);
+			Instanced->UpdateInstanceTransform(Ref.Instance, Transform, false, false, true);
+			DirtyInstanced.AddUnique(Instanced);
+		} else {
+			Component->SetHiddenInGame(true);
+			Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+	}
+
+	// One render state update per component for the whole batch
+	for (UInstancedStaticMeshComponent* Instanced : DirtyInstanced) {
+		Instanced->MarkRenderStateDirty();
+	}
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PropHealthSubsystem.generated.h"
+
+class UPrimitiveComponent;
+struct FHitResult;
+
+/** A damageable prop: a primitive component, or one instance of an instanced static mesh */
+struct FPropRef
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Instance index for the instanced static meshes, INDEX_NONE otherwise */
+	int32 Instance = INDEX_NONE;
+
+	bool operator==(const FPropRef& Other) const { return Component == Other.Component && Instance == Other.Instance; }
+
+	friend uint32 GetTypeHash(const FPropRef& Ref) { return HashCombine(GetTypeHash(Ref.Component), ::GetTypeHash(Ref.Instance)); }
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FPropBatchDelegate, TConstArrayView<FPropRef> /* Props */);
+
+/**
+ * Health of the level props, without a component per prop.
+ * A primitive opts in with the component or actor tag "Destructible" (DefaultMaxHealth) or "PropHealth=<N>".
+ * Only the damaged props are stored, as the fraction of health left and the time of the last hit, keyed
+ * by component and instance: a prop never hit costs nothing. Regeneration walks the store once per
+ * RegenInterval, destructions are handled and broadcast once per frame, and nothing ticks in between.
+ * The max health of a primitive is parsed on its first hit and cached until its level goes away.
+ * Explosions only reach the props of the "Destructible" object type, the DestructibleProp collision
+ * profile, found by an overlap when they go off: nothing is walked or indexed when a level is loaded.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UPropHealthSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Max health of the props tagged "Destructible" */
+	float DefaultMaxHealth = 100.0f;
+
+	/** Fraction of the max health recovered per second, 0 keeps the damage */
+	float RegenRate = 0.0f;
+
+	/** Time without damage before a prop starts to regenerate */
+	float RegenDelay = 5.0f;
+
+	/** Seconds between two regeneration passes over the store */
+	float RegenInterval = 0.5f;
+
+	/** Hide and stop the collision of the destroyed props, else they are only broadcast */
+	bool bHideDestroyed = true;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Damage the prop hit by a shot, the GetDamage of the actors without a UHealthComponent.
+	 * @return False if the hit primitive isn't a destructible prop
+	 */
+	static bool DamageHit(const FHitResult& Hit, float Amount);
+
+	/** @return False if Component isn't a destructible prop or is already destroyed */
+	bool ApplyDamage(UPrimitiveComponent* Component, int32 Instance, float Amount);
+
+	/** Fraction of health left, 1 for a prop never hit */
+	float GetHealthFraction(UPrimitiveComponent* Component, int32 Instance) const;
+
+	/** Max health read from the tags of Component or its owner, 0 if it isn't destructible. Cached per component */
+	float GetMaxHealth(const UPrimitiveComponent* Component);
+
+	/** World location of a prop, the instance location for the instanced static meshes */
+	static FVector GetPropLocation(const UPrimitiveComponent* Component, int32 Instance);
+
+	/** Props destroyed this frame */
+	FPropBatchDelegate& OnPropsDestroyed() { return PropsDestroyed; }
+
+	/** Props back to full health, dropped from the store */
+	FPropBatchDelegate& OnPropsRestored() { return PropsRestored; }
+
+	int32 NumDamagedProps() const { return Props.Num(); }
+
+private:
+	struct FPropHealth
+	{
+		float Health = 1.0f;
+		float LastDamageTime = 0.0f;
+	};
+
+	TMap<FPropRef, FPropHealth> Props;
+
+	/** Max health by component, 0 for the primitives that aren't destructible */
+	TMap<TWeakObjectPtr<const UPrimitiveComponent>, float> MaxHealths;
+
+	FDelegateHandle LevelRemovedHandle;
+
+	/** Entries of Props at zero health, kept so a destroyed prop can't be destroyed twice */
+	int32 NumDestroyed = 0;
+
+	/** Destroyed since the last tick */
+	TArray<FPropRef> Destroyed;
+
+	TArray<FPropRef> Restored;
+
+	float RegenClock = 0.0f;
+
+	FPropBatchDelegate PropsDestroyed;
+
+	FPropBatchDelegate PropsRestored;
+
+	void Regenerate(float DeltaTime);
+
+	/** Drop the cached max health of the components of Level */
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** Parse the tags of Component or its owner */
+	float ReadMaxHealth(const UPrimitiveComponent* Component) const;
+
+	void HideDestroyed();
+};
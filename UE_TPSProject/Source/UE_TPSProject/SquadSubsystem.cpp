@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SquadSubsystem.h"
+
+#include "CoverIndex.h"
+#include "EnemyAIController.h"
+#include "FrameScratch.h"
+#include "NavigationSystem.h"
+#include "BehaviorTree/BlackboardComponent.h"
+
+void USquadSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	CoverIndex = ACoverIndex::FindInWorld(&InWorld);
+}
+
+TStatId USquadSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USquadSubsystem, STATGROUP_Tickables);
+}
+
+void USquadSubsystem::RegisterMember(AEnemyAIController* Member, int32 SquadId) {
+	FSquad& Squad = Squads.FindOrAdd(SquadId);
+	Squad.Members.AddUnique(Member);
+}
+
+void USquadSubsystem::UnregisterMember(AEnemyAIController* Member) {
+	for (auto& Pair : Squads) {
+		Pair.Value.Members.Remove(Member);
+	}
+	Reservations.Remove(Member);
+}
+
+void USquadSubsystem::Tick(float DeltaTime) {
+	for (auto& Pair : Squads) {
+		FSquad& Squad = Pair.Value;
+
+		// Collect the plan of the previous interval once the worker is done
+		if (Squad.PendingPlan.IsValid()) {
+			if (!Squad.PendingPlan.IsCompleted()) {
+				continue;
+			}
+			ApplyPlan(Squad);
+		}
+
+		Squad.TimeUntilUpdate -= DeltaTime;
+		if (Squad.TimeUntilUpdate > 0.0f) {
+			continue;
+		}
+		Squad.TimeUntilUpdate = UpdateInterval;
+
+		FSquadSnapshot Snapshot;
+		if (!GatherSnapshot(Squad, Snapshot)) {
+			// Nobody engages, the spots go back to the other squads
+			ReleaseReservations(Squad);
+			continue;
+		}
+
+		Squad.PendingPlan = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Snapshot = MoveTemp(Snapshot), PreferredRange = PreferredRange, MinSeparation = MinSeparation, CoverBonus = CoverBonus, TravelWeight = TravelWeight]() {
+				return PlanSquad(Snapshot, PreferredRange, MinSeparation, CoverBonus, TravelWeight);
+			});
+	}
+}
+
+bool USquadSubsystem::GatherSnapshot(FSquad& Squad, FSquadSnapshot& Snapshot) {
+	Squad.PlannedMembers.Reset();
+	AActor* Target = nullptr;
+
+	for (const TWeakObjectPtr<AEnemyAIController>& Member : Squad.Members) {
+		if (!Member.IsValid() || !Member->GetPawn()) {
+			continue;
+		}
+
+		UBlackboardComponent* Blackboard = Member->GetBlackboardComponent();
+		if (!Blackboard || !Blackboard->GetValueAsBool("SeePlayer")) {
+			continue;
+		}
+
+		if (!Target) {
+			Target = Cast<AActor>(Blackboard->GetValueAsObject("Player"));
+		}
+
+		Squad.PlannedMembers.Add(Member);
+		Snapshot.MemberLocations.Add(Member->GetPawn()->GetActorLocation());
+	}
+
+	if (!Target || Squad.PlannedMembers.Num() == 0) {
+		Squad.PlannedMembers.Reset();
+		return false;
+	}
+
+	Snapshot.TargetLocation = Target->GetActorLocation();
+
+	// Members no longer engaging give their spot back
+	for (const TWeakObjectPtr<AEnemyAIController>& Member : Squad.Members) {
+		if (!Squad.PlannedMembers.Contains(Member)) {
+			Reservations.Remove(Member);
+		}
+	}
+
+	// The spots of the planned members are replaced by the plan, any other one is taken
+	for (const auto& Reservation : Reservations) {
+		if (!Squad.PlannedMembers.Contains(Reservation.Key)) {
+			Snapshot.Reserved.Add(Reservation.Value);
+		}
+	}
+
+	// Three rings of candidates around the target
+	const int32 NumAngles = 16;
+	const float RangeScales[] = {0.75f, 1.0f, 1.25f};
+
+	for (float RangeScale : RangeScales) {
+		for (int32 Angle = 0; Angle < NumAngles; Angle++) {
+			FVector Direction = FRotator(0.0f, Angle * (360.0f / NumAngles), 0.0f).Vector();
+			AddCandidate(Snapshot, Snapshot.TargetLocation + Direction * (PreferredRange * RangeScale));
+		}
+	}
+
+	return Snapshot.Candidates.Num() > 0;
+}
+
+void USquadSubsystem::AddCandidate(FSquadSnapshot& Snapshot, const FVector& Location) const {
+	FVector Candidate = Location;
+	bool bInCover = false;
+
+	// Prefer a baked cover protecting from the target
+	if (CoverIndex) {
+		int32 Cover = CoverIndex->FindNearestCover(Location, CoverSnapRadius, &Snapshot.TargetLocation);
+		if (Cover != INDEX_NONE) {
+			Candidate = CoverIndex->GetCoverPoint(Cover).GetLocation();
+			bInCover = true;
+		}
+	}
+
+	UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavigationSystem) {
+		FNavLocation NavLocation;
+		if (!NavigationSystem->ProjectPointToNavigation(Candidate, NavLocation)) {
+			return;
+		}
+		Candidate = NavLocation.Location;
+	}
+
+	Snapshot.Candidates.Add(Candidate);
+	Snapshot.CandidateInCover.Add(bInCover);
+}
+
+USquadSubsystem::FSquadPlan USquadSubsystem::PlanSquad(const FSquadSnapshot& Snapshot, float PreferredRange, float MinSeparation, float CoverBonus, float TravelWeight) {
+	const int32 NumMembers = Snapshot.MemberLocations.Num();
+	const int32 NumCandidates = Snapshot.Candidates.Num();
+
+	// Working arrays on the worker's own scratch stack, released when the plan is done
+	FMemMark Mark(FMemStack::Get());
+
+	// Squad-wide score of every candidate, computed once
+	TScratchArray<float> CandidateScores;
+	CandidateScores.SetNumUninitialized(NumCandidates);
+	for (int32 Candidate = 0; Candidate < NumCandidates; Candidate++) {
+		float Range = FVector::Dist(Snapshot.Candidates[Candidate], Snapshot.TargetLocation);
+		CandidateScores[Candidate] = -FMath::Abs(Range - PreferredRange) + (Snapshot.CandidateInCover[Candidate] ? CoverBonus : 0.0f);
+	}
+
+	FSquadPlan Plan;
+	Plan.Positions.Init(FVector::ZeroVector, NumMembers);
+	Plan.HasPosition.Init(false, NumMembers);
+
+	TScratchArray<bool> CandidateFree;
+	CandidateFree.Init(true, NumCandidates);
+	const float MinSeparationSquared = MinSeparation * MinSeparation;
+
+	// The spots held outside of the plan are taken from the start
+	for (const FVector& Reserved : Snapshot.Reserved) {
+		for (int32 Candidate = 0; Candidate < NumCandidates; Candidate++) {
+			if (FVector::DistSquared(Snapshot.Candidates[Candidate], Reserved) < MinSeparationSquared) {
+				CandidateFree[Candidate] = false;
+			}
+		}
+	}
+
+	// Greedy assignment: the best member/candidate pair is reserved first
+	for (int32 Round = 0; Round < NumMembers; Round++) {
+		int32 BestMember = INDEX_NONE;
+		int32 BestCandidate = INDEX_NONE;
+		float BestScore = -MAX_flt;
+
+		for (int32 Member = 0; Member < NumMembers; Member++) {
+			if (Plan.HasPosition[Member]) {
+				continue;
+			}
+
+			for (int32 Candidate = 0; Candidate < NumCandidates; Candidate++) {
+				if (!CandidateFree[Candidate]) {
+					continue;
+				}
+
+				float Score = CandidateScores[Candidate] - FVector::Dist(Snapshot.MemberLocations[Member], Snapshot.Candidates[Candidate]) * TravelWeight;
+				if (Score > BestScore) {
+					BestScore = Score;
+					BestMember = Member;
+					BestCandidate = Candidate;
+				}
+			}
+		}
+
+		if (BestMember == INDEX_NONE) {
+			break;
+		}
+
+		const FVector& Reserved = Snapshot.Candidates[BestCandidate];
+		Plan.Positions[BestMember] = Reserved;
+		Plan.HasPosition[BestMember] = true;
+
+		// Reserve the spot and its surroundings
+		for (int32 Candidate = 0; Candidate < NumCandidates; Candidate++) {
+			if (FVector::DistSquared(Snapshot.Candidates[Candidate], Reserved) < MinSeparationSquared) {
+				CandidateFree[Candidate] = false;
+			}
+		}
+	}
+
+	return Plan;
+}
+
+void USquadSubsystem::ApplyPlan(FSquad& Squad) {
+	const FSquadPlan& Plan = Squad.PendingPlan.GetResult();
+	const int32 NumMembers = Squad.PlannedMembers.Num();
+	bool bConflict = false;
+
+	// The plan replaces the spots of its members, a previous spot kept below is checked like a new one
+	TScratchArray<FVector> PreviousSpots;
+	PreviousSpots.Init(FVector::ZeroVector, NumMembers);
+	TScratchArray<bool> HadSpot;
+	HadSpot.Init(false, NumMembers);
+
+	for (int32 Member = 0; Member < NumMembers; Member++) {
+		FVector Spot;
+		if (Reservations.RemoveAndCopyValue(Squad.PlannedMembers[Member], Spot)) {
+			PreviousSpots[Member] = Spot;
+			HadSpot[Member] = true;
+		}
+	}
+
+	for (int32 Member = 0; Member < NumMembers; Member++) {
+		AEnemyAIController* Controller = Squad.PlannedMembers[Member].Get();
+		UBlackboardComponent* Blackboard = Controller ? Controller->GetBlackboardComponent() : nullptr;
+
+		if (!Blackboard) {
+			continue;
+		}
+
+		bool bHasPosition = Plan.HasPosition[Member];
+		FVector Position = Plan.Positions[Member];
+
+		// Taken since the snapshot by another squad, or next to a spot a member of this squad kept:
+		// the member keeps its previous spot if it is still clear
+		if (bHasPosition && IsReserved(Position)) {
+			bConflict = true;
+			bHasPosition = HadSpot[Member] && !IsReserved(PreviousSpots[Member]);
+			Position = PreviousSpots[Member];
+		}
+
+		Blackboard->SetValueAsBool("HasSquadPosition", bHasPosition);
+		if (bHasPosition) {
+			Blackboard->SetValueAsVector("SquadPosition", Position);
+			Reservations.Add(Controller, Position);
+		}
+	}
+
+	Squad.PendingPlan = {};
+	Squad.PlannedMembers.Reset();
+
+	// Plan again on the next tick, the snapshot will hold the spots taken meanwhile
+	if (bConflict) {
+		Squad.TimeUntilUpdate = 0.0f;
+	}
+}
+
+bool USquadSubsystem::IsReserved(const FVector& Location) const {
+	const float MinSeparationSquared = MinSeparation * MinSeparation;
+
+	for (const auto& Reservation : Reservations) {
+		if (FVector::DistSquared(Reservation.Value, Location) < MinSeparationSquared) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void USquadSubsystem::ReleaseReservations(const FSquad& Squad) {
+	for (const TWeakObjectPtr<AEnemyAIController>& Member : Squad.Members) {
+		Reservations.Remove(Member);
+	}
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "SquadSubsystem.generated.h"
+
+class AEnemyAIController;
+class ACoverIndex;
+
+/**
+ * Chooses the engage positions of every alerted squad.
+ * Candidate positions are gathered once per squad and interval on the game thread, scored and
+ * assigned to the members on a worker task, then written to the members' blackboards in one pass.
+ * A position is reserved for one member only, members never receive spots closer than MinSeparation.
+ * The reservations of all squads share one table: a plan avoids every spot held outside of it, and each
+ * position is checked against the table again when applied, since other squads plan on their own tasks
+ * meanwhile and a member of the same squad may keep its previous spot.
+ */
+UCLASS()
+class UE_TPSPROJECT_API USquadSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds between two position plans of the same squad */
+	float UpdateInterval = 0.5f;
+
+	/** Distance from the target the members try to keep */
+	float PreferredRange = 1200.0f;
+
+	/** Minimum distance between two reserved positions */
+	float MinSeparation = 200.0f;
+
+	/** Max distance used to snap a candidate to a baked cover point */
+	float CoverSnapRadius = 300.0f;
+
+	/** Score added to candidates protected by a cover */
+	float CoverBonus = 400.0f;
+
+	/** Score removed per unit travelled by the member to reach the candidate */
+	float TravelWeight = 0.5f;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterMember(AEnemyAIController* Member, int32 SquadId);
+
+	void UnregisterMember(AEnemyAIController* Member);
+
+private:
+	/** Game thread copy of the data a plan needs, read by the worker task only */
+	struct FSquadSnapshot
+	{
+		FVector TargetLocation;
+		TArray<FVector> MemberLocations;
+		TArray<FVector> Candidates;
+		TArray<bool> CandidateInCover;
+		/** Positions held by the controllers outside of the plan, of this squad or another */
+		TArray<FVector> Reserved;
+	};
+
+	/** Position chosen for every member of the snapshot, in the same order */
+	struct FSquadPlan
+	{
+		TArray<FVector> Positions;
+		TArray<bool> HasPosition;
+	};
+
+	struct FSquad
+	{
+		TArray<TWeakObjectPtr<AEnemyAIController>> Members;
+		float TimeUntilUpdate = 0.0f;
+		/** Members in the order of the snapshot being planned */
+		TArray<TWeakObjectPtr<AEnemyAIController>> PlannedMembers;
+		UE::Tasks::TTask<FSquadPlan> PendingPlan;
+	};
+
+	TMap<int32, FSquad> Squads;
+
+	/** Position held by every member of every squad, written on the game thread only */
+	TMap<TWeakObjectPtr<AEnemyAIController>, FVector> Reservations;
+
+	UPROPERTY(Transient)
+	ACoverIndex* CoverIndex;
+
+	/** Build the snapshot of the alerted members, false if nobody needs a position. The other members give their spot back */
+	bool GatherSnapshot(FSquad& Squad, FSquadSnapshot& Snapshot);
+
+	void AddCandidate(FSquadSnapshot& Snapshot, const FVector& Location) const;
+
+	/** Score the candidates and reserve one per member, runs on a worker thread */
+	static FSquadPlan PlanSquad(const FSquadSnapshot& Snapshot, float PreferredRange, float MinSeparation, float CoverBonus, float TravelWeight);
+
+	/** Write the plan to the blackboards, a position taken since the snapshot is planned again */
+	void ApplyPlan(FSquad& Squad);
+
+	/** True if Location is closer than MinSeparation to a held position */
+	bool IsReserved(const FVector& Location) const;
+
+	void ReleaseReservations(const FSquad& Squad);
+};
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TargetingSubsystem.h"
+
+#include "EnemyAIController.h"
+#include "FrameScratch.h"
+#include "HealthComponent.h"
+#include "UE_TPSProjectCharacter.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Float.h"
+#include "Perception/AIPerceptionComponent.h"
+
+TStatId UTargetingSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTargetingSubsystem, STATGROUP_Tickables);
+}
+
+bool UTargetingSubsystem::IsTickable() const {
+	return Controllers.Num() > 0 || PendingFrame.IsValid();
+}
+
+void UTargetingSubsystem::Deinitialize() {
+	PendingScoring.Wait();
+	PendingFrame.Reset();
+	Super::Deinitialize();
+}
+
+void UTargetingSubsystem::RegisterController(AEnemyAIController* Controller) {
+	Controllers.AddUnique(Controller);
+}
+
+void UTargetingSubsystem::UnregisterController(AEnemyAIController* Controller) {
+	Controllers.RemoveSwap(Controller);
+}
+
+void UTargetingSubsystem::RegisterPlayer(AUE_TPSProjectCharacter* Player) {
+	Players.AddUnique(Player);
+}
+
+void UTargetingSubsystem::UnregisterPlayer(AUE_TPSProjectCharacter* Player) {
+	Players.RemoveSwap(Player);
+}
+
+void UTargetingSubsystem::Tick(float DeltaTime) {
+	// Results of the previous frame, skip this frame if the workers are late
+	if (PendingFrame.IsValid()) {
+		if (!PendingScoring.IsCompleted()) {
+			return;
+		}
+		ApplyFrame(*PendingFrame);
+		PendingFrame.Reset();
+	}
+
+	TSharedPtr<FTargetingFrame> Frame = MakeShared<FTargetingFrame>();
+	GatherFrame(*Frame);
+
+	const int32 NumControllers = Frame->Controllers.Num();
+	if (NumControllers == 0 || Frame->Players.Num() == 0) {
+		return;
+	}
+
+	TScratchArray<UE::Tasks::FTask> Chunks;
+	for (int32 Begin = 0; Begin < NumControllers; Begin += ChunkSize) {
+		int32 End = FMath::Min(Begin + ChunkSize, NumControllers);
+		Chunks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Frame, Begin, End, MaxTargetDistance = MaxTargetDistance, TargetStickiness = TargetStickiness]() {
+				ScoreChunk(*Frame, Begin, End, MaxTargetDistance, TargetStickiness);
+			}));
+	}
+
+	PendingFrame = Frame;
+	PendingScoring = UE::Tasks::Launch(UE_SOURCE_LOCATION, []() {}, UE::Tasks::Prerequisites(Chunks));
+}
+
+void UTargetingSubsystem::GatherFrame(FTargetingFrame& Frame) const {
+	// Players first, the controllers store their perception as a mask over this list
+	for (const TWeakObjectPtr<AUE_TPSProjectCharacter>& PlayerPtr : Players) {
+		AUE_TPSProjectCharacter* Player = PlayerPtr.Get();
+		if (!Player || Frame.Players.Num() == 32) {
+			continue;
+		}
+
+		Frame.Players.Add(Player);
+		Frame.PlayerLocations.Add(FVector3f(Player->GetActorLocation()));
+		Frame.PlayerForwards.Add(FVector3f(Player->GetActorForwardVector()));
+		Frame.PlayerHealth.Add(Player->GetHealthComponent()->HealthPercentage());
+	}
+
+	const int32 NumControllers = Controllers.Num();
+	Frame.Controllers.Reserve(NumControllers);
+	Frame.Locations.Reserve(NumControllers);
+	Frame.Forwards.Reserve(NumControllers);
+	Frame.CurrentTargets.Reserve(NumControllers);
+	Frame.SensedMasks.Reserve(NumControllers);
+
+	for (const TWeakObjectPtr<AEnemyAIController>& Controller : Controllers) {
+		APawn* Pawn = Controller.IsValid() ? Controller->GetPawn() : nullptr;
+		UBlackboardComponent* Blackboard = Pawn ? Controller->GetBlackboardComponent() : nullptr;
+		if (!Blackboard) {
+			continue;
+		}
+
+		uint32 SensedMask = 0;
+		for (int32 Player = 0; Player < Frame.Players.Num(); Player++) {
+			const FActorPerceptionInfo* Info = Controller->GetPerceptionComponent()->GetActorInfo(*Frame.Players[Player]);
+			if (Info && Info->HasAnyCurrentStimulus()) {
+				SensedMask |= 1u << Player;
+			}
+		}
+
+		AActor* CurrentTarget = Blackboard->GetValueAsBool("SeePlayer") ? Cast<AActor>(Blackboard->GetValueAsObject("Player")) : nullptr;
+
+		Frame.Controllers.Add(Controller);
+		Frame.Locations.Add(FVector3f(Pawn->GetActorLocation()));
+		Frame.Forwards.Add(FVector3f(Pawn->GetActorForwardVector()));
+		Frame.CurrentTargets.Add(CurrentTarget ? Frame.Players.IndexOfByKey(CurrentTarget) : INDEX_NONE);
+		Frame.SensedMasks.Add(SensedMask);
+	}
+
+	Frame.BestTargets.SetNumUninitialized(Frame.Controllers.Num());
+	Frame.TargetDistances.SetNumUninitialized(Frame.Controllers.Num());
+	Frame.ThreatLevels.SetNumUninitialized(Frame.Controllers.Num());
+}
+
+void UTargetingSubsystem::ScoreChunk(FTargetingFrame& Frame, int32 Begin, int32 End, float MaxTargetDistance, float TargetStickiness) {
+	const int32 NumPlayers = Frame.Players.Num();
+
+	for (int32 Index = Begin; Index < End; Index++) {
+		const FVector3f Location = Frame.Locations[Index];
+		const FVector3f Forward = Frame.Forwards[Index];
+
+		int32 BestTarget = INDEX_NONE;
+		float BestScore = 0.0f;
+		float BestDistance = 0.0f;
+		float Threat = 0.0f;
+
+		for (int32 Player = 0; Player < NumPlayers; Player++) {
+			FVector3f ToPlayer = Frame.PlayerLocations[Player] - Location;
+			float Distance = ToPlayer.Size();
+			if (Distance > MaxTargetDistance) {
+				continue;
+			}
+
+			FVector3f Direction = Distance > KINDA_SMALL_NUMBER ? ToPlayer / Distance : Forward;
+			float Proximity = 1.0f - Distance / MaxTargetDistance;
+			bool bSensed = (Frame.SensedMasks[Index] >> Player) & 1u;
+
+			// Threat: close players looking at the enemy, perceived or not
+			float Facing = FMath::Max(FVector3f::DotProduct(Frame.PlayerForwards[Player], -Direction), 0.0f);
+			Threat = FMath::Max(Threat, Proximity * (0.5f + 0.5f * Facing));
+
+			if (!bSensed) {
+				continue;
+			}
+
+			// Target: perceived players, close, in front of the enemy and weakened
+			float InFront = 0.5f + 0.5f * FVector3f::DotProduct(Forward, Direction);
+			float Score = 0.5f * Proximity + 0.3f * InFront + 0.2f * (1.0f - Frame.PlayerHealth[Player]);
+			if (Player == Frame.CurrentTargets[Index]) {
+				Score += TargetStickiness;
+			}
+
+			if (Score > BestScore) {
+				BestScore = Score;
+				BestTarget = Player;
+				BestDistance = Distance;
+			}
+		}
+
+		Frame.BestTargets[Index] = BestTarget;
+		Frame.TargetDistances[Index] = BestDistance;
+		Frame.ThreatLevels[Index] = Threat;
+	}
+}
+
+bool UTargetingSubsystem::ResolveKeys(const UBlackboardComponent& Blackboard) {
+	const UBlackboardData* Asset = Blackboard.GetBlackboardAsset();
+	if (!Asset) {
+		return false;
+	}
+	if (Asset == KeysAsset.Get()) {
+		return true;
+	}
+	KeysAsset = Asset;
+
+	auto Resolve = [Asset](const FName& Name) {
+		FBlackboard::FKey Key = Asset->GetKeyID(Name);
+		if (Key == FBlackboard::InvalidKey) {
+			UE_LOG(LogTemp, Error, TEXT("Blackboard %s has no \"%s\" key, the targeting can't write it"), *Asset->GetName(), *Name.ToString());
+		}
+		return Key;
+	};
+
+	SeePlayerKey = Resolve(TEXT("SeePlayer"));
+	ThreatLevelKey = Resolve(TEXT("ThreatLevel"));
+	TargetDistanceKey = Resolve(TEXT("TargetDistance"));
+	return true;
+}
+
+void UTargetingSubsystem::ApplyFrame(const FTargetingFrame& Frame) {
+	for (int32 Index = 0; Index < Frame.Controllers.Num(); Index++) {
+		AEnemyAIController* Controller = Frame.Controllers[Index].Get();
+		UBlackboardComponent* Blackboard = Controller ? Controller->GetBlackboardComponent() : nullptr;
+		if (!Blackboard || !ResolveKeys(*Blackboard)) {
+			continue;
+		}
+
+		if (ThreatLevelKey != FBlackboard::InvalidKey) {
+			Blackboard->SetValue<UBlackboardKeyType_Float>(ThreatLevelKey, Frame.ThreatLevels[Index]);
+		}
+
+		int32 BestTarget = Frame.BestTargets[Index];
+		if (BestTarget == INDEX_NONE) {
+			continue;
+		}
+
+		if (TargetDistanceKey != FBlackboard::InvalidKey) {
+			Blackboard->SetValue<UBlackboardKeyType_Float>(TargetDistanceKey, Frame.TargetDistances[Index]);
+		}
+
+		// Switch the target of alerted controllers only, the detection itself stays with the perception
+		AUE_TPSProjectCharacter* Target = Cast<AUE_TPSProjectCharacter>(Frame.Players[BestTarget].Get());
+		if (Target && BestTarget != Frame.CurrentTargets[Index] && Blackboard->GetValue<UBlackboardKeyType_Bool>(SeePlayerKey)) {
+			Controller->SetTarget(Target);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "Tasks/Task.h"
+#include "TargetingSubsystem.generated.h"
+
+class AEnemyAIController;
+class AUE_TPSProjectCharacter;
+class UBlackboardComponent;
+
+/**
+ * Decision phase of the enemy AI: target and threat scoring for every controller.
+ * Each frame the game thread copies what the scoring reads (pawn and player transforms, perception,
+ * alert state) into contiguous arrays, the scoring runs in chunks on worker tasks, and the results
+ * are written to the blackboards in one pass on the next frame. Chunks are independent, so the cost
+ * spreads over the available cores.
+ * Blackboard keys written: "Player" (alerted controllers only), "ThreatLevel", "TargetDistance". Their IDs
+ * are resolved once per blackboard asset, a missing key is logged as an error and left unwritten.
+ * The registered controllers and players double as the lists the hot paths search instead of
+ * iterating the world actors.
+ */
+UCLASS()
+class UE_TPSPROJECT_API UTargetingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Controllers scored by one worker task */
+	int32 ChunkSize = 128;
+
+	/** Targets further away are ignored */
+	float MaxTargetDistance = 5000.0f;
+
+	/** Score kept by the current target to avoid switching every frame */
+	float TargetStickiness = 0.2f;
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterController(AEnemyAIController* Controller);
+
+	void UnregisterController(AEnemyAIController* Controller);
+
+	/** Characters the controllers can target, whether a player or a bot drives them */
+	void RegisterPlayer(AUE_TPSProjectCharacter* Player);
+
+	void UnregisterPlayer(AUE_TPSProjectCharacter* Player);
+
+	const TArray<TWeakObjectPtr<AEnemyAIController>>& GetControllers() const { return Controllers; }
+
+	const TArray<TWeakObjectPtr<AUE_TPSProjectCharacter>>& GetPlayers() const { return Players; }
+
+private:
+	/** Everything a scoring pass reads and writes, owned by the workers until the pass completes */
+	struct FTargetingFrame
+	{
+		// Controllers
+		TArray<TWeakObjectPtr<AEnemyAIController>> Controllers;
+		TArray<FVector3f> Locations;
+		TArray<FVector3f> Forwards;
+		TArray<int32> CurrentTargets;
+		/** Bit N set if the controller perceives the player N */
+		TArray<uint32> SensedMasks;
+
+		// Players
+		TArray<TWeakObjectPtr<AActor>> Players;
+		TArray<FVector3f> PlayerLocations;
+		TArray<FVector3f> PlayerForwards;
+		TArray<float> PlayerHealth;
+
+		// Results, one per controller
+		TArray<int32> BestTargets;
+		TArray<float> TargetDistances;
+		TArray<float> ThreatLevels;
+	};
+
+	TArray<TWeakObjectPtr<AEnemyAIController>> Controllers;
+
+	TArray<TWeakObjectPtr<AUE_TPSProjectCharacter>> Players;
+
+	TSharedPtr<FTargetingFrame> PendingFrame;
+
+	/** Completes when every chunk of PendingFrame is scored */
+	UE::Tasks::FTask PendingScoring;
+
+	/** Blackboard asset the key IDs below were resolved for */
+	TWeakObjectPtr<const UBlackboardData> KeysAsset;
+
+	FBlackboard::FKey SeePlayerKey = FBlackboard::InvalidKey;
+
+	FBlackboard::FKey ThreatLevelKey = FBlackboard::InvalidKey;
+
+	FBlackboard::FKey TargetDistanceKey = FBlackboard::InvalidKey;
+
+	/** Resolve the key IDs when Blackboard uses another asset than the last one, false if it has none */
+	bool ResolveKeys(const UBlackboardComponent& Blackboard);
+
+	void GatherFrame(FTargetingFrame& Frame) const;
+
+	/** Score the controllers [Begin, End), runs on a worker thread */
+	static void ScoreChunk(FTargetingFrame& Frame, int32 Begin, int32 End, float MaxTargetDistance, float TargetStickiness);
+
+	void ApplyFrame(const FTargetingFrame& Frame);
+};
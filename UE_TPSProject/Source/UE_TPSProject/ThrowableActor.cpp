@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ThrowableActor.h"
+
+#include "CollisionReport.h"
+#include "ExplosionSubsystem.h"
+
+AThrowableActor::AThrowableActor()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// The arc is analytic, the mesh never needs collision or physics
+	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	RootComponent = Mesh;
+
+	GravityZ = 0.0f;
+	Age = 0.0f;
+	bLanded = false;
+	bCosmetic = false;
+}
+
+void AThrowableActor::Launch(const FThrowableSlot& InSlot, const FVector& Start, const FVector& Velocity, AActor* InInstigator, bool bInCosmetic) {
+	Slot = InSlot;
+	ThrowInstigator = InInstigator;
+	LaunchLocation = Start;
+	LaunchVelocity = Velocity;
+	GravityZ = GetWorld()->GetGravityZ() * Slot.GravityScale;
+	Age = 0.0f;
+	bLanded = false;
+	bCosmetic = bInCosmetic;
+
+	Mesh->SetStaticMesh(Slot.ThrowableMesh);
+	SetActorLocation(Start);
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+}
+
+void AThrowableActor::Deactivate() {
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+	ThrowInstigator = nullptr;
+}
+
+void AThrowableActor::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	Age += DeltaTime;
+
+	if (!bLanded) {
+		FVector Current = GetActorLocation();
+		FVector Next = LaunchLocation + LaunchVelocity * Age + FVector(0.0f, 0.0f, 0.5f * GravityZ * Age * Age);
+
+		FCollisionQueryParams Params;
+		Params.AddIgnoredActor(this);
+		if (ThrowInstigator.IsValid()) {
+			Params.AddIgnoredActor(ThrowInstigator.Get());
+		}
+
+		FHitResult Hit;
+		bool bHit;
+		{
+			SCOPE_COLLISION_QUERY(this);
+			bHit = GetWorld()->LineTraceSingleByChannel(Hit, Current, Next, ECC_Visibility, Params);
+		}
+		if (bHit) {
+			Next = Hit.Location;
+			bLanded = true;
+		}
+		SetActorLocation(Next);
+	}
+
+	if (Age >= Slot.FuseTime) {
+		UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>();
+		if (Explosions) {
+			if (bCosmetic) {
+				Explosions->PlayEffects(GetActorLocation(), Slot);
+			} else {
+				Explosions->Explode(GetActorLocation(), Slot, ThrowInstigator.Get());
+			}
+			Explosions->ReleaseThrowable(this);
+		} else {
+			Deactivate();
+		}
+	}
+}
+
+void AThrowableActor::PredictArc(const UWorld* World, const FVector& Start, const FVector& Velocity, float GravityZ, float MaxTime,
+	float TimeStep, const AActor* IgnoredActor, TArray<FVector>& OutPoints) {
+	OutPoints.Reset();
+	OutPoints.Add(Start);
+
+	FCollisionQueryParams Params;
+	Params.AddIgnoredActor(IgnoredActor);
+
+	FVector Previous = Start;
+	for (float Time = TimeStep; Time <= MaxTime; Time += TimeStep) {
+		FVector Point = Start + Velocity * Time + FVector(0.0f, 0.0f, 0.5f * GravityZ * Time * Time);
+
+		FHitResult Hit;
+		if (World->LineTraceSingleByChannel(Hit, Previous, Point, ECC_Visibility, Params)) {
+			OutPoints.Add(Hit.Location);
+			return;
+		}
+
+		OutPoints.Add(Point);
+		Previous = Point;
+	}
+}
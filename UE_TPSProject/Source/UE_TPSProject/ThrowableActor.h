@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FThrowableSlot.h"
+#include "ThrowableActor.generated.h"
+
+/**
+ * Pooled thrown explosive. Follows the analytic ballistic arc of its launch instead of a
+ * physics simulation, stops on the first blocking surface and explodes when the fuse ends.
+ * Never replicated: the server runs the throwable that deals the damage, the clients launch a
+ * cosmetic copy from the same parameters that only plays the explosion effects.
+ */
+UCLASS()
+class UE_TPSPROJECT_API AThrowableActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AThrowableActor();
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Take the throwable out of the pool and launch it */
+	void Launch(const FThrowableSlot& InSlot, const FVector& Start, const FVector& Velocity, AActor* InInstigator, bool bInCosmetic);
+
+	/** Hide the throwable and stop its tick, ready to go back in the pool */
+	void Deactivate();
+
+	/**
+	 * Sample the arc a throwable launched with Velocity would follow.
+	 * Stops at the first blocking surface or after MaxTime seconds.
+	 */
+	static void PredictArc(const UWorld* World, const FVector& Start, const FVector& Velocity, float GravityZ, float MaxTime,
+		float TimeStep, const AActor* IgnoredActor, TArray<FVector>& OutPoints);
+
+private:
+	UPROPERTY(VisibleAnywhere, Category = "Throwable")
+	UStaticMeshComponent* Mesh;
+
+	FThrowableSlot Slot;
+
+	TWeakObjectPtr<AActor> ThrowInstigator;
+
+	FVector LaunchLocation;
+
+	FVector LaunchVelocity;
+
+	float GravityZ;
+
+	float Age;
+
+	bool bLanded;
+
+	/** Only plays the explosion effects, no damage */
+	bool bCosmetic;
+};
@@ -6,7 +6,7 @@ public class UE_TPSProject : ModuleRules
 {
 	public UE_TPSProject(ReadOnlyTargetRules Target) : base(Target)
 	{
-		PrivateDependencyModuleNames.AddRange(new string[] { "AIModule", "AIModule" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "AIModule", "AIModule", "AnimationBudgetAllocator", "GameplayTasks", "NavigationSystem" });
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
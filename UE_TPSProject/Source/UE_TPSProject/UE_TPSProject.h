@@ -3,3 +3,37 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/World.h"
+
+/** Trace channel of the weapon shots, see the collision settings in DefaultEngine.ini */
+#define ECC_Weapon ECC_GameTraceChannel1
+
+/** Object channel of the destructible props, the only one the explosions overlap */
+#define ECC_Destructible ECC_GameTraceChannel2
+
+/** Collision profile of the weapon meshes held by the characters, never in the physics scene */
+#define COLLISION_PROFILE_WEAPON_MESH TEXT("WeaponMesh")
+
+/** Collision profile of the character capsules, the only body of a living character */
+#define COLLISION_PROFILE_CHARACTER TEXT("TPSCharacter")
+
+/** Collision profile of the character skeletal meshes, no physics asset bodies */
+#define COLLISION_PROFILE_CHARACTER_MESH TEXT("TPSCharacterMesh")
+
+/** Collision profile of the capsule of a dead character, out of the broadphase: its movement must be disabled first */
+#define COLLISION_PROFILE_CORPSE TEXT("Corpse")
+
+/** Collision profile of the destructible props, the explosions find them on their object channel */
+#define COLLISION_PROFILE_DESTRUCTIBLE_PROP TEXT("DestructibleProp")
+
+/** Particles, sounds, debug draws and camera curves, compiled out of the dedicated server target */
+#define WITH_COSMETICS !UE_SERVER
+
+/** False on a dedicated server, constant false in the server target so the cosmetic branches are stripped */
+FORCEINLINE bool ShouldPlayCosmetics(const UWorld* World) {
+#if WITH_COSMETICS
+	return World && World->GetNetMode() != NM_DedicatedServer;
+#else
+	return false;
+#endif
+}
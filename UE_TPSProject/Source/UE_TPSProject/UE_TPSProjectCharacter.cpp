@@ -1,16 +1,33 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "UE_TPSProjectCharacter.h"
+#include "UE_TPSProject.h"
 
 #include "Enemy.h"
+#include "CombatRecorderSubsystem.h"
+#include "CombatTelemetry.h"
+#include "GameEventSubsystem.h"
+#include "HitboxComponent.h"
+#include "HUDViewModelComponent.h"
+#include "CollisionReport.h"
+#include "CoverIndex.h"
+#include "ExplosionSubsystem.h"
+#include "FrameScratch.h"
+#include "ProjectileSubsystem.h"
+#include "PropHealthSubsystem.h"
+#include "TargetingSubsystem.h"
+#include "ThrowableActor.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "UE_TPSProject/HealthComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
 
 // ATP_ThirdPersonCharacter
 
@@ -49,9 +66,23 @@ AUE_TPSProjectCharacter::AUE_TPSProjectCharacter() {
 	// Add a mesh for the weapon
 	WeaponMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("WeaponMesh"));
 	WeaponMesh->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform, "hand_rSocket");
+	// No physics state, the weapon follows the hand bone every frame without touching the physics scene
+	WeaponMesh->SetCollisionProfileName(COLLISION_PROFILE_WEAPON_MESH);
+	WeaponMesh->SetGenerateOverlapEvents(false);
 
 	//Add component for Health management
 	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("Health Component"));
+
+	// Shots stop on the capsule and are resolved on the hitbox proxies, the mesh has no bodies at all
+	Hitbox = CreateDefaultSubobject<UHitboxComponent>(TEXT("Hitbox"));
+	GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_CHARACTER);
+	GetMesh()->SetCollisionProfileName(COLLISION_PROFILE_CHARACTER_MESH);
+
+	// Add the state read by the HUD widgets
+	HUDViewModel = CreateDefaultSubobject<UHUDViewModelComponent>(TEXT("HUD View Model"));
+
+	//Add component for aim and crouch transitions
+	CurveDriver = CreateDefaultSubobject<UCurveDriverComponent>(TEXT("Curve Driver"));
 	
 	//Set other variabled
 	ActiveWeapon = 0;
@@ -66,28 +97,57 @@ void AUE_TPSProjectCharacter::BeginPlay() {
 	
 	bCanMove = true;
 	MagBullets = Arsenal[ActiveWeapon].MagCapacity;
-	FireTime = 0.0f;
+	PushAuthoritativeWeaponState(0);
+
+	// Bound once, the sequences allocate nothing when they run
+	ReloadAction.Init(this);
+	ReloadAction.OnFinished.BindWeakLambda(this, [this](bool bCancelled) {
+		if (!bCancelled) {
+			EndReload();
+		}
+	});
+	FireAction.Init(this);
+	FireAction.OnStep.BindUObject(this, &AUE_TPSProjectCharacter::FireStep);
+	AimAction.Init(this);
 	FVector WeaponLocation = GetMesh()->GetSocketLocation("hand_rSocket");
 	FRotator WeaponRotaion = GetMesh()->GetSocketRotation("hand_rSocket");
 	
 	MaxSpeedWalkingOrig = GetCharacterMovement()->MaxWalkSpeed;
-	if (MovementCurve && OffsetCurve) {
-		FOnTimelineFloat ProgressFunctionLength;
-		ProgressFunctionLength.BindUFunction(this, "HandleProgressArmLength");
-		AimTimeline.AddInterpFloat(MovementCurve, ProgressFunctionLength);
-
-		FOnTimelineVector ProgressFunctionOffset;
-		ProgressFunctionOffset.BindUFunction(this, "HandleProgressCameraOffset");
-		AimTimeline.AddInterpVector(OffsetCurve, ProgressFunctionOffset);
+	// The camera only matters to the viewer, the server never builds the aim track
+	if (MovementCurve && OffsetCurve && ShouldPlayCosmetics(GetWorld())) {
+		AimTrack = CurveDriver->AddTrack();
+		CurveDriver->AddFloatCurve(AimTrack, MovementCurve,
+			FCurveDriverFloat::CreateUObject(this, &AUE_TPSProjectCharacter::HandleProgressArmLength));
+		CurveDriver->AddVectorCurve(AimTrack, OffsetCurve,
+			FCurveDriverVector::CreateUObject(this, &AUE_TPSProjectCharacter::HandleProgressCameraOffset));
 	}
 
 	if (CrouchCurve) {
-		FOnTimelineFloat ProgressFunctionCrouch;
-		ProgressFunctionCrouch.BindUFunction(this, "HandleProgressCrouch");
-		CrouchTimeline.AddInterpFloat(CrouchCurve, ProgressFunctionCrouch);
+		CrouchTrack = CurveDriver->AddTrack();
+		CurveDriver->AddFloatCurve(CrouchTrack, CrouchCurve,
+			FCurveDriverFloat::CreateUObject(this, &AUE_TPSProjectCharacter::HandleProgressCrouch));
+	}
+
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Subscribe(EGameEvent::HealthZero, this, this, FGameEventDelegate::CreateWeakLambda(this, [this](const FGameEvent&) {
+			StopCharacter();
+		}));
+	}
+
+	CoverIndex = ACoverIndex::FindInWorld(GetWorld());
+
+	// Players and bots alike, the enemies look them up here instead of iterating the actors
+	if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+		Targeting->RegisterPlayer(this);
+	}
+}
+
+void AUE_TPSProjectCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<UTargetingSubsystem>()) {
+		Targeting->UnregisterPlayer(this);
 	}
 
-	HealthComponent->OnHealtToZero.AddDynamic(this, &AUE_TPSProjectCharacter::StopCharacter);
+	Super::EndPlay(EndPlayReason);
 }
 
 void AUE_TPSProjectCharacter::OnConstruction(const FTransform & Transform) {
@@ -100,13 +160,15 @@ void AUE_TPSProjectCharacter::OnConstruction(const FTransform & Transform) {
 void AUE_TPSProjectCharacter::Tick(float DeltaTime) {
 	Super::Tick(DeltaTime);
 
-	AimTimeline.TickTimeline(DeltaTime);
-	CrouchTimeline.TickTimeline(DeltaTime);
-	
-	AutomaticFire(DeltaTime);
+	CheckCover();
+
+	UCombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCombatRecorderSubsystem>();
+	if (Recorder && Recorder->IsRecording() && InputComponent && IsLocallyControlled()) {
+		RecordAxes(Recorder);
+	}
 }
 
-// Timeline management
+// Curve management
 
 void AUE_TPSProjectCharacter::HandleProgressArmLength(float Length) {
 	CameraBoom->TargetArmLength = Length;
@@ -122,34 +184,95 @@ void AUE_TPSProjectCharacter::HandleProgressCrouch(float Height) {
 
 // Input
 
+TArrayView<const AUE_TPSProjectCharacter::FActionBinding> AUE_TPSProjectCharacter::GetActionBindings() {
+	static const FActionBinding Bindings[] = {
+		{ TEXT("Sprint"), IE_Pressed, &AUE_TPSProjectCharacter::StartSprint },
+		{ TEXT("Sprint"), IE_Released, &AUE_TPSProjectCharacter::EndSprint },
+		{ TEXT("Crouch"), IE_Pressed, &AUE_TPSProjectCharacter::CrouchCharacter },
+		{ TEXT("Crouch"), IE_Released, &AUE_TPSProjectCharacter::StopCrouchCharacter },
+		{ TEXT("Aim"), IE_Pressed, &AUE_TPSProjectCharacter::AimInWeapon },
+		{ TEXT("Aim"), IE_Released, &AUE_TPSProjectCharacter::AimOutWeapon },
+		{ TEXT("AimArch"), IE_Pressed, &AUE_TPSProjectCharacter::AimInArch },
+		{ TEXT("AimArch"), IE_Released, &AUE_TPSProjectCharacter::AimOutArch },
+		{ TEXT("Fire"), IE_Pressed, &AUE_TPSProjectCharacter::Fire },
+		{ TEXT("Fire"), IE_Released, &AUE_TPSProjectCharacter::StopFire },
+		{ TEXT("Reload"), IE_Pressed, &AUE_TPSProjectCharacter::ReloadWeapon },
+	};
+	return Bindings;
+}
+
+TArrayView<const AUE_TPSProjectCharacter::FAxisBinding> AUE_TPSProjectCharacter::GetAxisBindings() {
+	// We have 2 versions of the rotation bindings to handle different kinds of devices differently
+	// "turn" handles devices that provide an absolute delta, such as a mouse.
+	// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
+	static const FAxisBinding Bindings[] = {
+		{ TEXT("MoveForward"), &AUE_TPSProjectCharacter::MoveForward },
+		{ TEXT("MoveRight"), &AUE_TPSProjectCharacter::MoveRight },
+		{ TEXT("Turn"), &APawn::AddControllerYawInput },
+		{ TEXT("TurnRate"), &AUE_TPSProjectCharacter::TurnAtRate },
+		{ TEXT("LookUp"), &APawn::AddControllerPitchInput },
+		{ TEXT("LookUpRate"), &AUE_TPSProjectCharacter::LookUpAtRate },
+	};
+	return Bindings;
+}
+
 void AUE_TPSProjectCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) {
 	// Set up gameplay key bindings
 	check(PlayerInputComponent);
 
-	PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &AUE_TPSProjectCharacter::StartSprint);
-	PlayerInputComponent->BindAction("Sprint", IE_Released, this, &AUE_TPSProjectCharacter::EndSprint);
-	
-	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &AUE_TPSProjectCharacter::CrouchCharacter);
-	PlayerInputComponent->BindAction("Crouch", IE_Released, this, &AUE_TPSProjectCharacter::StopCrouchCharacter);
-	
-	PlayerInputComponent->BindAction("Aim", IE_Pressed, this, &AUE_TPSProjectCharacter::AimInWeapon);
-	PlayerInputComponent->BindAction("Aim", IE_Released, this, &AUE_TPSProjectCharacter::AimOutWeapon);
+	TArrayView<const FActionBinding> Actions = GetActionBindings();
+	for (int32 Action = 0; Action < Actions.Num(); Action++) {
+		// The action is also kept in the combat record, when one is running
+		FInputActionBinding ActionBinding(Actions[Action].Name, Actions[Action].Event);
+		ActionBinding.ActionDelegate.GetDelegateForManualSet().BindWeakLambda(this, [this, Action]() {
+			DispatchAction(Action);
+			if (UCombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCombatRecorderSubsystem>()) {
+				Recorder->RecordAction(Action);
+			}
+		});
+		PlayerInputComponent->AddActionBinding(MoveTemp(ActionBinding));
+	}
 
-	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &AUE_TPSProjectCharacter::Fire);
-	PlayerInputComponent->BindAction("Fire", IE_Released, this, &AUE_TPSProjectCharacter::StopFire);
-	
-	PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &AUE_TPSProjectCharacter::ReloadWeapon);
+	for (const FAxisBinding& Binding : GetAxisBindings()) {
+		PlayerInputComponent->BindAxis(Binding.Name, this, Binding.Handler);
+	}
+}
 
-	PlayerInputComponent->BindAxis("MoveForward", this, &AUE_TPSProjectCharacter::MoveForward);
-	PlayerInputComponent->BindAxis("MoveRight", this, &AUE_TPSProjectCharacter::MoveRight);
+int32 AUE_TPSProjectCharacter::NumRecordedAxes() {
+	return GetAxisBindings().Num();
+}
 
-	// We have 2 versions of the rotation bindings to handle different kinds of devices differently
-	// "turn" handles devices that provide an absolute delta, such as a mouse.
-	// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
-	PlayerInputComponent->BindAxis("Turn", this, &APawn::AddControllerYawInput);
-	PlayerInputComponent->BindAxis("TurnRate", this, &AUE_TPSProjectCharacter::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUp", this, &APawn::AddControllerPitchInput);
-	PlayerInputComponent->BindAxis("LookUpRate", this, &AUE_TPSProjectCharacter::LookUpAtRate);
+int32 AUE_TPSProjectCharacter::FindAction(const TCHAR* Name, EInputEvent Event) {
+	return GetActionBindings().IndexOfByPredicate([Name, Event](const FActionBinding& Binding) {
+		return Binding.Event == Event && FCString::Strcmp(Binding.Name, Name) == 0;
+	});
+}
+
+int32 AUE_TPSProjectCharacter::FindAxis(const TCHAR* Name) {
+	return GetAxisBindings().IndexOfByPredicate([Name](const FAxisBinding& Binding) {
+		return FCString::Strcmp(Binding.Name, Name) == 0;
+	});
+}
+
+void AUE_TPSProjectCharacter::RecordAxes(UCombatRecorderSubsystem* Recorder) {
+	TArrayView<const FAxisBinding> Axes = GetAxisBindings();
+	for (int32 Axis = 0; Axis < Axes.Num(); Axis++) {
+		Recorder->RecordAxis(Axis, InputComponent->GetAxisValue(Axes[Axis].Name));
+	}
+}
+
+void AUE_TPSProjectCharacter::DispatchAxis(int32 Axis, float Value) {
+	TArrayView<const FAxisBinding> Axes = GetAxisBindings();
+	if (Axes.IsValidIndex(Axis)) {
+		(this->*Axes[Axis].Handler)(Value);
+	}
+}
+
+void AUE_TPSProjectCharacter::DispatchAction(int32 Action) {
+	TArrayView<const FActionBinding> Actions = GetActionBindings();
+	if (Actions.IsValidIndex(Action)) {
+		(this->*Actions[Action].Handler)();
+	}
 }
 
 // Movement and rotation
@@ -209,6 +332,37 @@ void AUE_TPSProjectCharacter::AimOutWeapon() {
 	AimOut();
 }
 
+void AUE_TPSProjectCharacter::AimInArch() {
+	if(bIsSprinting || bIsUsingWeapon || !Throwables.IsValidIndex(ActiveThrowable) || Throwables[ActiveThrowable].Count <= 0)
+		return;
+
+	bIsUsingArch = true;
+	AimIn();
+}
+
+void AUE_TPSProjectCharacter::AimOutArch() {
+	if (!bIsUsingArch)
+		return;
+
+	// Releasing the arch aim throws
+	FVector Start;
+	FVector Velocity;
+	ComputeThrow(Start, Velocity);
+	Throwables[ActiveThrowable].Count--;
+
+	if (HasAuthority()) {
+		LaunchThrowable(ActiveThrowable, Start, Velocity, false);
+		MulticastThrow(ActiveThrowable, Start, Velocity);
+	} else {
+		// The arc is analytic, the local copy follows the server one without any replication
+		LaunchThrowable(ActiveThrowable, Start, Velocity, true);
+		ServerThrow(Velocity);
+	}
+
+	bIsUsingArch = false;
+	AimOut();
+}
+
 void AUE_TPSProjectCharacter::AimIn() {
 	if(bIsSprinting)
 		return;
@@ -218,12 +372,15 @@ void AUE_TPSProjectCharacter::AimIn() {
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	GetCharacterMovement()->MaxWalkSpeed = MaxSpeedAiming;
 	bIsAiming = true;
+	AimAction.Start(AimTransitionTime);
 	if (bIsInCover) {
 		GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Aim from cover"));
 		StopCrouchCharacter();
 	}
-	AimTimeline.Play();
+	CurveDriver->Play(AimTrack);
+	UGameEventSubsystem::Post(this, EGameEvent::Aim);
 	OnCharacterAim.Broadcast();
+	UpdateViewModel();
 }
 
 void AUE_TPSProjectCharacter::AimOut() {
@@ -235,23 +392,28 @@ void AUE_TPSProjectCharacter::AimOut() {
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->MaxWalkSpeed = MaxSpeedWalkingOrig;
 	bIsAiming = false;
+	AimAction.Cancel();
 	if (bIsInCover) {
 		GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Stop aim from cover"));
 		CrouchCharacter();
 		
 	}
-	AimTimeline.Reverse();
+	CurveDriver->Reverse(AimTrack);
+	UGameEventSubsystem::Post(this, EGameEvent::StopAim);
 	OnCharacterStopAim.Broadcast();
+	UpdateViewModel();
 }
 
 void AUE_TPSProjectCharacter::Landed(const FHitResult& Hit) {
 	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("landed"));
+	UGameEventSubsystem::Post(this, EGameEvent::Landing);
 	OnCharacterLanding.Broadcast();
 }
 
 /** This is a UE4 function of AActor class*/
 void AUE_TPSProjectCharacter::OnJumped_Implementation() { 
 	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("On jumped"));
+	UGameEventSubsystem::Post(this, EGameEvent::Jumping);
 	OnCharacterJumping.Broadcast();
 }
 
@@ -272,7 +434,7 @@ void AUE_TPSProjectCharacter::StartSprint()
 	bIsSprinting = true;
 	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Sprinting"));
 	GetCharacterMovement()->MaxWalkSpeed = MaxSpeedSprinting;
-	OnCharacterStartSprint.Broadcast();
+	UGameEventSubsystem::Post(this, EGameEvent::StartSprint);
 }
 
 void AUE_TPSProjectCharacter::EndSprint()
@@ -280,7 +442,7 @@ void AUE_TPSProjectCharacter::EndSprint()
 	bIsSprinting = false;
 	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("End Sprinting"));
 	GetCharacterMovement()->MaxWalkSpeed = MaxSpeedWalkingOrig;
-	OnCharacterEndSprint.Broadcast();
+	UGameEventSubsystem::Post(this, EGameEvent::EndSprint);
 }
 
 // Mechanic: Crouch
@@ -292,7 +454,8 @@ void AUE_TPSProjectCharacter::CrouchCharacter() {
 	if (CanCrouch()) {
 		GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Crouch in"));
 		Crouch();
-		CrouchTimeline.Play();
+		CurveDriver->Play(CrouchTrack);
+		UGameEventSubsystem::Post(this, EGameEvent::Crouch);
 		OnCharacterCrouch.Broadcast();
 	}
 }
@@ -301,87 +464,242 @@ void AUE_TPSProjectCharacter::StopCrouchCharacter() {
 	GEngine->AddOnScreenDebugMessage(-1, 0.2f, FColor::Green, TEXT("Uncrouch"));
 	if (GetCharacterMovement()->IsCrouching()) {
 		UnCrouch();
-		CrouchTimeline.Reverse();
+		CurveDriver->Reverse(CrouchTrack);
+		UGameEventSubsystem::Post(this, EGameEvent::Uncrouch);
 		OnCharacterUncrouch.Broadcast();
 	}
 }
 
+// Mechanic: Cover
+
+void AUE_TPSProjectCharacter::CheckCover() {
+	if (!CoverIndex) {
+		bCanTakeCover = false;
+		return;
+	}
+
+	FVector Feet = GetActorLocation() - FVector::UpVector * GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	int32 Cover = CoverIndex->FindNearestCover(Feet, CheckCoverRadius);
+
+	bCanTakeCover = Cover != INDEX_NONE;
+	if (bCanTakeCover) {
+		CoverDirectionMovement = CoverIndex->GetCoverPoint(Cover).GetTangent();
+	}
+}
+
+// Mechanic: Throw
+
+void AUE_TPSProjectCharacter::ComputeThrow(FVector& Start, FVector& Velocity) {
+	const FThrowableSlot& Throwable = Throwables[ActiveThrowable];
+	FRotator ThrowRotation = GetControlRotation() + FRotator(Throwable.ThrowAngle, 0.0f, 0.0f);
+
+	Start = GetMesh()->GetSocketLocation("hand_rSocket");
+	Velocity = ThrowRotation.Vector() * Throwable.ThrowSpeed;
+}
+
+void AUE_TPSProjectCharacter::LaunchThrowable(int32 ThrowableIndex, const FVector& Start, const FVector& Velocity, bool bCosmetic) {
+	UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>();
+	AThrowableActor* Throwable = Explosions ? Explosions->AcquireThrowable() : nullptr;
+
+	if (Throwable) {
+		Throwable->Launch(Throwables[ThrowableIndex], Start, Velocity, this, bCosmetic);
+	}
+}
+
+void AUE_TPSProjectCharacter::ServerThrow_Implementation(FVector_NetQuantize Velocity) {
+	if (!Throwables.IsValidIndex(ActiveThrowable) || Throwables[ActiveThrowable].Count <= 0) {
+		return;
+	}
+
+	// Only the direction comes from the client, the launch point and speed are the server ones
+	Throwables[ActiveThrowable].Count--;
+	FVector ServerStart = GetMesh()->GetSocketLocation("hand_rSocket");
+	FVector ServerVelocity = Velocity.GetSafeNormal() * Throwables[ActiveThrowable].ThrowSpeed;
+	LaunchThrowable(ActiveThrowable, ServerStart, ServerVelocity, false);
+	MulticastThrow(ActiveThrowable, ServerStart, ServerVelocity);
+}
+
+void AUE_TPSProjectCharacter::MulticastThrow_Implementation(uint8 ThrowableIndex, FVector_NetQuantize Start, FVector_NetQuantize Velocity) {
+	// The server runs the real throwable, the thrower its own copy, a dedicated server has nothing to show
+	if (HasAuthority() || IsLocallyControlled() || !ShouldPlayCosmetics(GetWorld()) || !Throwables.IsValidIndex(ThrowableIndex)) {
+		return;
+	}
+
+	LaunchThrowable(ThrowableIndex, Start, Velocity, true);
+}
+
+void AUE_TPSProjectCharacter::PredictThrowArc(TArray<FVector>& Points) {
+	if (!Throwables.IsValidIndex(ActiveThrowable)) {
+		Points.Reset();
+		return;
+	}
+
+	FVector Start;
+	FVector Velocity;
+	ComputeThrow(Start, Velocity);
+
+	float GravityZ = GetWorld()->GetGravityZ() * Throwables[ActiveThrowable].GravityScale;
+	AThrowableActor::PredictArc(GetWorld(), Start, Velocity, GravityZ, ThrowPreviewTime, 0.05f, this, Points);
+}
+
 // Mechanic: Fire with weapon
 
 void AUE_TPSProjectCharacter::FireFromWeapon() {
+	SCOPE_HOT_PATH(Fire);
+
 	if(bIsReloading || bIsSprinting){
 		return;
 	}
-	
-	FCollisionQueryParams Params;
-	// Ignore the player's pawn
-	Params.AddIgnoredActor(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
 
-	// The hit result gets populated by the line trace
+	FVector Start;
+	FVector End;
+	ComputeShotSegment(Start, End);
+
+	bool bProjectile = Arsenal[ActiveWeapon].FireMode == EWeaponFireMode::Projectile;
+
+	// The shooter always traces and plays the cosmetics locally, without waiting for the server
 	FHitResult Hit;
+	bool bHit = false;
+	if (!bProjectile) {
+		bHit = TraceShot(Start, End, Hit);
+		UGameEventSubsystem::Post(this, EGameEvent::TraceLine);
+	}
+	PlayFireEffects(bHit, Hit.ImpactPoint);
+	UCombatRecorderSubsystem::RecordEvent(this, ECombatRecordEvent::Fire, this);
+	MagBullets--;
+	UpdateViewModel();
+
+	if (HasAuthority()) {
+		FCombatTelemetry::Record(CombatTelemetry::ERecordType::Shot, this);
 
+		if (bProjectile) {
+			LaunchProjectile(Start, End);
+		} else {
+			if (bHit) {
+				AEnemy* HitActor = Cast<AEnemy>(Hit.GetActor());
+
+				// The trace stops on the capsule, the hitbox proxies tell where the body is hit
+				const FWeaponSlot& Weapon = Arsenal[ActiveWeapon];
+				float Damage = HitActor ? UHitboxComponent::ComputeDamage(HitActor, Weapon.Damage, Weapon.ZoneDamage, Start, End - Start) : 0.0f;
+				if (Damage > 0.0f) {
+					FCombatTelemetry::Record(CombatTelemetry::ERecordType::Hit, this, HitActor);
+					HitActor->GetHealthComponent()->GetDamage(Damage);
+				} else if (!HitActor) {
+					UPropHealthSubsystem::DamageHit(Hit, Weapon.Damage);
+				}
+			}
+			MulticastFireEffects(bHit, Hit.ImpactPoint);
+		}
+		PushAuthoritativeWeaponState(AuthoritativeWeaponState.LastPredictionKey);
+		return;
+	}
+
+	// Owning client: keep the shot as predicted, damage is applied by the server only
+	uint16 PredictionKey = GeneratePredictionKey();
+	PendingWeaponActions.Add({PredictionKey, EPredictedWeaponAction::Shot});
+	// Stamped with the server clock as estimated by the client, the server bounds it by its own
+	AGameStateBase* GameState = GetWorld()->GetGameState();
+	float ShotTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	ServerFire(Start, (End - Start).GetSafeNormal(), PredictionKey, ShotTime);
+}
+
+void AUE_TPSProjectCharacter::ComputeShotSegment(FVector& Start, FVector& End) {
 	float WeaponRange = Arsenal[ActiveWeapon].Range;
 
-	FVector Start = FollowCamera->GetComponentLocation();
-	FVector End = Start + (FollowCamera->GetComponentRotation().Vector() * WeaponRange);
+	Start = FollowCamera->GetComponentLocation();
+	End = Start + (FollowCamera->GetComponentRotation().Vector() * WeaponRange);
 
-	if (!bIsAiming) {
+	// Until the aim transition is over the shot leaves from the weapon
+	if (!bIsAiming || AimAction.IsRunning()) {
 		float WeaponOffset = Arsenal[ActiveWeapon].Offset;
-		GEngine->AddOnScreenDebugMessage(-1, 5.2f, FColor::Emerald, TEXT("Not aiming!"));
+		if (ShouldPlayCosmetics(GetWorld())) {
+			GEngine->AddOnScreenDebugMessage(-1, 5.2f, FColor::Emerald, TEXT("Not aiming!"));
+		}
 		Start = WeaponMesh->GetComponentLocation() + (WeaponMesh->GetForwardVector() * WeaponOffset);
 		End = Start + (WeaponMesh->GetComponentRotation().Vector() * WeaponRange);
 	}
+}
+
+bool AUE_TPSProjectCharacter::TraceShot(const FVector& Start, const FVector& End, FHitResult& Hit) {
+	FCollisionQueryParams Params;
+	// Ignore the shooter's pawn
+	Params.AddIgnoredActor(this);
+
+	bool bHit;
+	{
+		SCOPE_COLLISION_QUERY(this);
+		bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Weapon, Params);
+	}
+	if (bHit && ShouldPlayCosmetics(GetWorld())) {
+		DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 3.0f);
+	}
+	return bHit;
+}
+
+void AUE_TPSProjectCharacter::LaunchProjectile(const FVector& Start, const FVector& End) {
+	if (UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>()) {
+		Projectiles->FireProjectile(this, Start, End - Start, Arsenal[ActiveWeapon]);
+	}
+}
 
-	bool bHit = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Pawn, Params);
-	OnCharacterTraceLine.Broadcast();
+void AUE_TPSProjectCharacter::PlayFireEffects(bool bHit, const FVector& ImpactPoint) {
+	if (!ShouldPlayCosmetics(GetWorld())) {
+		return;
+	}
 
 	if (bHit) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 3.0f);
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Arsenal[ActiveWeapon].HitEFX, Hit.ImpactPoint);
-		AEnemy* HitActor = Cast<AEnemy>(Hit.GetActor());
-		
-		if (HitActor) {
-			HitActor->GetHealthComponent()->GetDamage(Arsenal[ActiveWeapon].Damage);
-		}
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Arsenal[ActiveWeapon].HitEFX, ImpactPoint);
 	}
 
 	UGameplayStatics::PlaySound2D(this, Arsenal[ActiveWeapon].SoundEFX, 1.0f, 1.0f, 0);
 }
 
-void AUE_TPSProjectCharacter::AutomaticFire(float DeltaTime) {
-	if (Arsenal[ActiveWeapon].IsAutomatic && bIsFiring) {
-		FireTime += DeltaTime;
-		if (FireTime >= Arsenal[ActiveWeapon].Rate) {
-			FireTime = 0.0f;
-			if (MagBullets > 0) {
-				FireFromWeapon();
-				MagBullets--;
-			} else {
-				StopFire();
-				ReloadWeapon();
-			}
-		}
+void AUE_TPSProjectCharacter::MulticastFireEffects_Implementation(bool bHit, FVector_NetQuantize ImpactPoint) {
+	// The shooter already played them, a dedicated server has nothing to show
+	if (IsLocallyControlled() || !ShouldPlayCosmetics(GetWorld())) {
+		return;
+	}
+
+	if (bHit) {
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Arsenal[ActiveWeapon].HitEFX, ImpactPoint);
 	}
 }
 
-void AUE_TPSProjectCharacter::Fire() {
-	if (!bIsReloading) {
-		bIsFiring = true;
-		FireTime = 0.0f;
-		if (MagBullets > 0) {
-			FireFromWeapon();
-			MagBullets--;
-		} else {
-			StopFire();
-			ReloadWeapon();
-		}
+bool AUE_TPSProjectCharacter::FireStep() {
+	if (MagBullets <= 0) {
+		StopFire();
+		ReloadWeapon();
+		return false;
 	}
+
+	FireFromWeapon();
+	return true;
 }
 
+void AUE_TPSProjectCharacter::Fire() {
+	const FWeaponSlot& Weapon = Arsenal[ActiveWeapon];
+	int32 Shots = Weapon.IsAutomatic ? Weapon.BurstCount : 1;
+	bIsFiring = true;
+
+	// Pulled during a reload: the trigger is kept and the shots start with the full magazine
+	if (bIsReloading) {
+		FireAction.Await(ReloadAction, Weapon.Rate, Shots, 0.0f);
+		return;
+	}
+
+	// The first shot leaves on the press, the rest of the burst follows at the weapon rate
+	if (FireStep() && Shots != 1) {
+		FireAction.Start(Weapon.Rate, FMath::Max(Shots - 1, 0));
+	}
+}
 
 void AUE_TPSProjectCharacter::StopFire() {
 	bIsFiring = false;
-	FireTime = 0.0f;
+
+	// A fixed burst completes on its own, a full-auto stream or a trigger kept during a reload stops here
+	if (FireAction.IsWaiting() || Arsenal[ActiveWeapon].BurstCount == 0) {
+		FireAction.Cancel();
+	}
 }
 
 FWeaponSlot AUE_TPSProjectCharacter::RetrieveActiveWeapon() {
@@ -398,33 +716,222 @@ void AUE_TPSProjectCharacter::ReloadWeapon() {
 	if (!bIsUsingArch) {
 		GEngine->AddOnScreenDebugMessage(-1, 5.2f, FColor::Red, TEXT("Start Reload!"));
 		bIsReloading = true;
+		ReloadAction.Start(Arsenal[ActiveWeapon].ReloadTime);
+		UGameEventSubsystem::Post(this, EGameEvent::StartReload);
 		OnCharacterStartReload.Broadcast();
+
+		if (HasAuthority()) {
+			PushAuthoritativeWeaponState(AuthoritativeWeaponState.LastPredictionKey);
+		} else {
+			uint16 PredictionKey = GeneratePredictionKey();
+			PendingWeaponActions.Add({PredictionKey, EPredictedWeaponAction::ReloadStart});
+			ServerReloadWeapon(PredictionKey);
+		}
 	}
 }
 
 void AUE_TPSProjectCharacter::EndReload() {
+	// Only the owning machine drives the reload, the server copy of a remote pawn waits for ServerEndReload
+	if (!IsLocallyControlled() || !bIsReloading) {
+		return;
+	}
+
 	GEngine->AddOnScreenDebugMessage(-1, 5.2f, FColor::Orange, TEXT("End Reload!"));
 	bIsReloading = false;
 	MagBullets = Arsenal[ActiveWeapon].MagCapacity;
+	UpdateViewModel();
+
+	if (HasAuthority()) {
+		PushAuthoritativeWeaponState(AuthoritativeWeaponState.LastPredictionKey);
+	} else {
+		uint16 PredictionKey = GeneratePredictionKey();
+		PendingWeaponActions.Add({PredictionKey, EPredictedWeaponAction::ReloadEnd});
+		ServerEndReload(PredictionKey);
+	}
+
+	// Called early by an animation the timed reload ends here, a trigger kept during the reload fires now
+	ReloadAction.Complete();
 }
 
 int AUE_TPSProjectCharacter::MagCounter() {
 	return MagBullets;
 }
 
+// Network: client prediction and server reconciliation
+
+void AUE_TPSProjectCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AUE_TPSProjectCharacter, AuthoritativeWeaponState, COND_OwnerOnly);
+}
+
+uint16 AUE_TPSProjectCharacter::GeneratePredictionKey() {
+	// Zero is the "nothing acknowledged yet" value
+	if (++NextPredictionKey == 0) {
+		++NextPredictionKey;
+	}
+	return NextPredictionKey;
+}
+
+void AUE_TPSProjectCharacter::RestoreWeaponState(int32 InActiveWeapon, int32 InMagBullets) {
+	if (!Arsenal.IsValidIndex(InActiveWeapon)) {
+		return;
+	}
+
+	ActiveWeapon = InActiveWeapon;
+	MagBullets = FMath::Clamp(InMagBullets, 0, Arsenal[ActiveWeapon].MagCapacity);
+	bIsReloading = false;
+	ReloadAction.Cancel();
+	GetWorldTimerManager().ClearTimer(ServerReloadTimer);
+	WeaponMesh->SetStaticMesh(Arsenal[ActiveWeapon].WeaponMesh);
+
+	if (HasAuthority()) {
+		PushAuthoritativeWeaponState(AuthoritativeWeaponState.LastPredictionKey);
+	}
+}
+
+void AUE_TPSProjectCharacter::PushAuthoritativeWeaponState(uint16 PredictionKey) {
+	AuthoritativeWeaponState.MagBullets = MagBullets;
+	AuthoritativeWeaponState.bIsReloading = bIsReloading;
+	AuthoritativeWeaponState.LastPredictionKey = PredictionKey;
+	UpdateViewModel();
+}
+
+bool AUE_TPSProjectCharacter::ServerFire_Validate(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, uint16 PredictionKey, float ClientTimeStamp) {
+	return FMath::IsFinite(ClientTimeStamp) && !Direction.IsNearlyZero();
+}
+
+void AUE_TPSProjectCharacter::ServerFire_Implementation(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, uint16 PredictionKey, float ClientTimeStamp) {
+	SCOPE_HOT_PATH(Fire);
+
+	const FWeaponSlot& Weapon = Arsenal[ActiveWeapon];
+
+	// Cadence is checked on the client clock, so latency and jitter don't change the accepted rate. A clock
+	// running ahead of the server would fire faster, the timestamps may not pass the server time plus the round trip
+	float RoundTrip = GetPlayerState() ? GetPlayerState()->GetPingInMilliseconds() * 0.001f : 0.0f;
+	bool bClockOk = ClientTimeStamp <= GetWorld()->GetTimeSeconds() + RoundTrip + MaxShotClockAhead;
+	bool bRateOk = bClockOk && (LastServerShotTime < 0.0f || (ClientTimeStamp - LastServerShotTime) >= Weapon.Rate * FireRateTolerance);
+	bool bOriginOk = FVector::Dist(Start, GetActorLocation()) <= MaxShotOriginError + CameraBoom->TargetArmLength;
+
+	if (!bIsReloading && MagBullets > 0 && bRateOk && bOriginOk) {
+		LastServerShotTime = ClientTimeStamp;
+		MagBullets--;
+		FCombatTelemetry::Record(CombatTelemetry::ERecordType::Shot, this);
+
+		FVector End = Start + (Direction * Weapon.Range);
+
+		if (Weapon.FireMode == EWeaponFireMode::Projectile) {
+			LaunchProjectile(Start, End);
+		} else {
+			FHitResult Hit;
+			bool bHit = TraceShot(Start, End, Hit);
+			UGameEventSubsystem::Post(this, EGameEvent::TraceLine);
+
+			if (bHit) {
+				AEnemy* HitActor = Cast<AEnemy>(Hit.GetActor());
+
+				float Damage = HitActor ? UHitboxComponent::ComputeDamage(HitActor, Weapon.Damage, Weapon.ZoneDamage, Start, Direction) : 0.0f;
+				if (Damage > 0.0f) {
+					FCombatTelemetry::Record(CombatTelemetry::ERecordType::Hit, this, HitActor);
+					HitActor->GetHealthComponent()->GetDamage(Damage);
+				} else if (!HitActor) {
+					UPropHealthSubsystem::DamageHit(Hit, Weapon.Damage);
+				}
+			}
+			MulticastFireEffects(bHit, Hit.ImpactPoint);
+		}
+	}
+
+	// Acknowledge the key even when rejected, the client rolls back to the state below
+	PushAuthoritativeWeaponState(PredictionKey);
+}
+
+void AUE_TPSProjectCharacter::ServerReloadWeapon_Implementation(uint16 PredictionKey) {
+	if (!bIsReloading && MagBullets < Arsenal[ActiveWeapon].MagCapacity) {
+		bIsReloading = true;
+		ServerReloadStartTime = GetWorld()->GetTimeSeconds();
+		GetWorldTimerManager().ClearTimer(ServerReloadTimer);
+		UGameEventSubsystem::Post(this, EGameEvent::StartReload);
+		OnCharacterStartReload.Broadcast();
+	}
+	PushAuthoritativeWeaponState(PredictionKey);
+}
+
+void AUE_TPSProjectCharacter::ServerEndReload_Implementation(uint16 PredictionKey) {
+	if (bIsReloading) {
+		// An end sent before the reload time is held until then, the client rolls back to reloading meanwhile
+		float Remaining = Arsenal[ActiveWeapon].ReloadTime - ReloadTimeTolerance - (GetWorld()->GetTimeSeconds() - ServerReloadStartTime);
+		if (Remaining <= 0.0f) {
+			FinishServerReload();
+		} else {
+			GetWorldTimerManager().SetTimer(ServerReloadTimer, this, &AUE_TPSProjectCharacter::FinishServerReload, Remaining);
+		}
+	}
+	PushAuthoritativeWeaponState(PredictionKey);
+}
+
+void AUE_TPSProjectCharacter::FinishServerReload() {
+	if (!bIsReloading) {
+		return;
+	}
+
+	bIsReloading = false;
+	MagBullets = Arsenal[ActiveWeapon].MagCapacity;
+	PushAuthoritativeWeaponState(AuthoritativeWeaponState.LastPredictionKey);
+}
+
+void AUE_TPSProjectCharacter::OnRep_AuthoritativeWeaponState() {
+	// Forget what the server has already processed...
+	PendingWeaponActions.RemoveAll([this](const FPredictedWeaponAction& Pending) {
+		return FAuthoritativeWeaponState::IsKeyAcknowledged(Pending.PredictionKey, AuthoritativeWeaponState.LastPredictionKey);
+	});
+
+	// ...and replay the actions still in flight on top of the server state
+	MagBullets = AuthoritativeWeaponState.MagBullets;
+	bIsReloading = AuthoritativeWeaponState.bIsReloading;
+
+	for (const FPredictedWeaponAction& Pending : PendingWeaponActions) {
+		switch (Pending.Action) {
+		case EPredictedWeaponAction::Shot:
+			MagBullets--;
+			break;
+		case EPredictedWeaponAction::ReloadStart:
+			bIsReloading = true;
+			break;
+		case EPredictedWeaponAction::ReloadEnd:
+			bIsReloading = false;
+			MagBullets = Arsenal[ActiveWeapon].MagCapacity;
+			break;
+		}
+	}
+	UpdateViewModel();
+}
+
 // Utilities
 
 void AUE_TPSProjectCharacter::StopCharacter() {
-	HealthComponent->OnHealtToZero.RemoveDynamic(this, &AUE_TPSProjectCharacter::StopCharacter);
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::Death, nullptr, this);
+	if (UGameEventSubsystem* Events = GetWorld()->GetSubsystem<UGameEventSubsystem>()) {
+		Events->Unsubscribe(this);
+	}
 	if (bIsAiming) {
 		AimOut();
 	}
+	FireAction.Cancel();
+	ReloadAction.Cancel();
+	// Without collision a moving capsule would fall through the floor
+	GetCharacterMovement()->DisableMovement();
+	GetCapsuleComponent()->SetCollisionProfileName(COLLISION_PROFILE_CORPSE);
 	
 	EnablePlayerInput(false);
 }
 
 void AUE_TPSProjectCharacter::EnablePlayerInput(bool Enabled) {
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	// Each pawn toggles the input of its own controller, bots have none to toggle
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (!PlayerController) {
+		return;
+	}
 
 	if (Enabled) {
 		EnableInput(PlayerController);
@@ -433,6 +940,12 @@ void AUE_TPSProjectCharacter::EnablePlayerInput(bool Enabled) {
 	}
 }
 
+void AUE_TPSProjectCharacter::UpdateViewModel() {
+	HUDViewModel->SetAmmo(MagBullets, Arsenal[ActiveWeapon].MagCapacity);
+	HUDViewModel->SetWeapon(ActiveWeapon);
+	HUDViewModel->SetAim(IsAimingWithWeapon(), IsAimingWithArch());
+}
+
 void AUE_TPSProjectCharacter::EnableMovement(bool Enabled) {
 	bCanMove = Enabled;
 }
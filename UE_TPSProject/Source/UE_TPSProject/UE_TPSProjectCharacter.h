@@ -3,13 +3,20 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Components/TimelineComponent.h"
+#include "CurveDriverComponent.h"
 #include "FWeaponSlot.h"
+#include "FWeaponPrediction.h"
+#include "FThrowableSlot.h"
 #include "GameFramework/Character.h"
+#include "LatentActionSubsystem.h"
 #include "UE_TPSProject/HealthComponent.h"
 #include "Logging/LogMacros.h"
 #include "UE_TPSProjectCharacter.generated.h"
 
+class ACoverIndex;
+class UHitboxComponent;
+class UHUDViewModelComponent;
+class UCombatRecorderSubsystem;
 class USpringArmComponent;
 class UCameraComponent;
 class UInputMappingContext;
@@ -41,6 +48,18 @@ class AUE_TPSProjectCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Health", meta = (AllowPrivateAccess = "true"))
 	UHealthComponent* HealthComponent;
 
+	/** Body part capsules resolving where the shots hit */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Health", meta = (AllowPrivateAccess = "true"))
+	UHitboxComponent* Hitbox;
+
+	/** HUD state, updated when it changes instead of polled by the widgets */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	UHUDViewModelComponent* HUDViewModel;
+
+	/** Drives the aim and crouch curves, sleeps when no transition is playing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Timeline", meta = (AllowPrivateAccess = "true"))
+	UCurveDriverComponent* CurveDriver;
+
 public:
 	AUE_TPSProjectCharacter();
 
@@ -72,17 +91,6 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FGameStateCharacter OnCharacterStartReload;
 
-	/** Broadcsted when character trace line from weapon */
-	UPROPERTY(BlueprintAssignable)
-	FGameStateCharacter OnCharacterTraceLine;
-
-	/** Broadcsted when character starts sprinting */
-	UPROPERTY(BlueprintAssignable)
-	FGameStateCharacter OnCharacterStartSprint;
-
-	/** Broadcsted when character stops sprinting */
-	UPROPERTY(BlueprintAssignable)
-	FGameStateCharacter OnCharacterEndSprint;
 	
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -100,6 +108,10 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Aim")
 	float MaxSpeedAiming = 150.0f;
 
+	/** Seconds between AimIn and the shots leaving from the camera, they leave from the weapon before */
+	UPROPERTY(EditAnywhere, Category = "Aim")
+	float AimTransitionTime = 0.25f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aim")
 	float ActualEight = 0.0f;
 
@@ -116,6 +128,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
 	TArray<FWeaponSlot> Arsenal;
 
+	/** This array contains all the character throwables*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapons")
+	TArray<FThrowableSlot> Throwables;
+
+	/** Seconds of flight shown by the throw trajectory preview */
+	UPROPERTY(EditAnywhere, Category = "Weapons")
+	float ThrowPreviewTime = 2.0f;
+
+	/** Fraction of the weapon Rate the server accepts between two client shots, absorbs timestamp jitter */
+	UPROPERTY(EditAnywhere, Category = "Weapons|Network")
+	float FireRateTolerance = 0.9f;
+
+	/** Max distance between the shot origin sent by the client and the server pawn location */
+	UPROPERTY(EditAnywhere, Category = "Weapons|Network")
+	float MaxShotOriginError = 250.0f;
+
+	/** Seconds a shot timestamp may run ahead of the server clock plus the round trip time */
+	UPROPERTY(EditAnywhere, Category = "Weapons|Network")
+	float MaxShotClockAhead = 0.1f;
+
+	/** Seconds the server takes off the weapon ReloadTime before it accepts the end of a client reload */
+	UPROPERTY(EditAnywhere, Category = "Weapons|Network")
+	float ReloadTimeTolerance = 0.15f;
+
 private:
 	int ActiveWeapon;
 
@@ -125,8 +161,6 @@ private:
 
 	float MaxSpeedWalkingOrig;
 
-	float FireTime;
-
 	float CheckCoverRadius;
 
 	bool bIsAiming;
@@ -147,34 +181,123 @@ private:
 
 	bool bIsSprinting = false;
 	
-	/** Timeline use for aiming: change the visual from 360 to right shoulder*/
-	FTimeline AimTimeline;
+	/** Last prediction key generated by this client */
+	uint16 NextPredictionKey = 0;
+
+	/** Client timestamp of the last shot accepted by the server */
+	float LastServerShotTime = -1.0f;
+
+	/** Server time the reload of the owning client started at */
+	float ServerReloadStartTime = -1.0f;
+
+	/** Ends on the server a reload the client ended too early */
+	FTimerHandle ServerReloadTimer;
+
+	/** Fill the magazine of a reload accepted by the server */
+	void FinishServerReload();
+
+	/** Weapon actions predicted by the owning client and not yet acknowledged */
+	TArray<FPredictedWeaponAction> PendingWeaponActions;
+
+	/** Weapon state as seen by the server */
+	UPROPERTY(ReplicatedUsing = OnRep_AuthoritativeWeaponState)
+	FAuthoritativeWeaponState AuthoritativeWeaponState;
 
-	/** Timeline used to crouch character*/
-	FTimeline CrouchTimeline;
+	/** Timed weapon sequences: reload until the magazine is full, the shots of a trigger pull, the aim transition */
+	FLatentAction ReloadAction;
+	FLatentAction FireAction;
+	FLatentAction AimAction;
+
+	/** Curve track used for aiming: change the visual from 360 to right shoulder*/
+	int32 AimTrack = INDEX_NONE;
+
+	/** Curve track used to crouch character*/
+	int32 CrouchTrack = INDEX_NONE;
 
 	/** This variable stores the allowed movement while player is covering*/
 	FVector CoverDirectionMovement;
 
-	UFUNCTION()
+	/** Baked cover points of the level, null if the level has none */
+	UPROPERTY(Transient)
+	ACoverIndex* CoverIndex;
+
 	void HandleProgressArmLength(float Length);
 	
-	UFUNCTION()
 	void HandleProgressCameraOffset(FVector Offset);
 
-	UFUNCTION()
 	void HandleProgressCrouch(float Height);
 
 	UFUNCTION()
 	void StopCharacter();
 	
+	/** Input bindings, the index in these tables identifies the input in the combat records */
+	struct FActionBinding
+	{
+		const TCHAR* Name;
+		EInputEvent Event;
+		void (AUE_TPSProjectCharacter::*Handler)();
+	};
+
+	struct FAxisBinding
+	{
+		const TCHAR* Name;
+		void (AUE_TPSProjectCharacter::*Handler)(float);
+	};
+
+	static TArrayView<const FActionBinding> GetActionBindings();
+	static TArrayView<const FAxisBinding> GetAxisBindings();
+
 	void EnablePlayerInput(bool Enabled);
 
 	void EnableMovement(bool Enabled);
 
+	/** Push the ammo, weapon and aim state to the HUD view model */
+	void UpdateViewModel();
+
+	// Mechanic: Cover
+	/** Look for a baked cover point within CheckCoverRadius */
+	void CheckCover();
+
 	// Mechanic: Fire with weapon
 	void FireFromWeapon();
-	void AutomaticFire(float DeltaTime);
+	/** One shot of FireAction, false once the magazine is empty */
+	bool FireStep();
+	void ComputeShotSegment(FVector& Start, FVector& End);
+	bool TraceShot(const FVector& Start, const FVector& End, FHitResult& Hit);
+	void LaunchProjectile(const FVector& Start, const FVector& End);
+	void PlayFireEffects(bool bHit, const FVector& ImpactPoint);
+
+	// Mechanic: Throw
+	void ComputeThrow(FVector& Start, FVector& Velocity);
+	/** Launch a throwable of slot ThrowableIndex, a cosmetic one only shows the arc and the explosion */
+	void LaunchThrowable(int32 ThrowableIndex, const FVector& Start, const FVector& Velocity, bool bCosmetic);
+
+	UFUNCTION(Server, Reliable)
+	void ServerThrow(FVector_NetQuantize Velocity);
+
+	/** Launches a cosmetic copy of a server throw on the other clients, the thrower already launched its own */
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastThrow(uint8 ThrowableIndex, FVector_NetQuantize Start, FVector_NetQuantize Velocity);
+
+	// Network: client prediction and server reconciliation
+	uint16 GeneratePredictionKey();
+	void PushAuthoritativeWeaponState(uint16 PredictionKey);
+
+	UFUNCTION()
+	void OnRep_AuthoritativeWeaponState();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFire(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, uint16 PredictionKey, float ClientTimeStamp);
+
+	UFUNCTION(Server, Reliable)
+	void ServerReloadWeapon(uint16 PredictionKey);
+
+	UFUNCTION(Server, Reliable)
+	void ServerEndReload(uint16 PredictionKey);
+
+	/** Plays the fire cosmetics on the other machines, the shooter already played them */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastFireEffects(bool bHit, FVector_NetQuantize ImpactPoint);
 
 
 protected:
@@ -216,6 +339,8 @@ protected:
 	void AimOutWeapon();
 	void AimIn();
 	void AimOut();
+	void AimInArch();
+	void AimOutArch();
 
 	// Mechanic: Reload
 	void ReloadWeapon();
@@ -223,7 +348,9 @@ protected:
 public:
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	virtual void Landed(const FHitResult& Hit) override;
 	virtual void OnJumped_Implementation();
@@ -242,15 +369,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "TPS")
 	bool IsAimingWithArch();
 
+	/** Fill Points with the trajectory of the active throwable, for the arc preview */
+	UFUNCTION(BlueprintCallable, Category = "TPS")
+	void PredictThrowArc(TArray<FVector>& Points);
+
 	UFUNCTION(BlueprintCallable, Category = "Reload")
 	int MagCounter();
 
+	bool IsReloading() const { return bIsReloading; }
+
 	UFUNCTION(BlueprintCallable, Category = "TPS")
 	FWeaponSlot RetrieveActiveWeapon();
 
+	// Weapon state stored in mission saves
+	int32 GetActiveWeaponIndex() const { return ActiveWeapon; }
+	void RestoreWeaponState(int32 InActiveWeapon, int32 InMagBullets);
+
 	UFUNCTION(BlueprintCallable, Category = "Health")
 	FORCEINLINE class UHealthComponent* GetHealthComponent() const { return HealthComponent; }
 
+	UFUNCTION(BlueprintCallable, Category = "HUD")
+	FORCEINLINE class UHUDViewModelComponent* GetHUDViewModel() const { return HUDViewModel; }
+
+	// Input bindings by index, used by the combat records and the bots
+	static int32 NumRecordedAxes();
+	static int32 FindAction(const TCHAR* Name, EInputEvent Event);
+	static int32 FindAxis(const TCHAR* Name);
+	void RecordAxes(UCombatRecorderSubsystem* Recorder);
+	void DispatchAxis(int32 Axis, float Value);
+	void DispatchAction(int32 Action);
+
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
@@ -2,7 +2,22 @@
 
 #include "UE_TPSProjectGameMode.h"
 #include "UE_TPSProjectCharacter.h"
+#include "BotController.h"
+#include "CombatTelemetry.h"
+#include "Engine/NetDriver.h"
+#include "EngineUtils.h"
 #include "UObject/ConstructorHelpers.h"
+#include "UObject/UObjectArray.h"
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnBotsCommand(
+	TEXT("TPS.SpawnBots"),
+	TEXT("Spawn player characters driven by bots. Usage: TPS.SpawnBots <count>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		AUE_TPSProjectGameMode* GameMode = World ? World->GetAuthGameMode<AUE_TPSProjectGameMode>() : nullptr;
+		if (GameMode && Args.Num() > 0) {
+			GameMode->SpawnBots(FCString::Atoi(*Args[0]));
+		}
+	}));
 
 AUE_TPSProjectGameMode::AUE_TPSProjectGameMode()
 {
@@ -12,4 +27,124 @@ AUE_TPSProjectGameMode::AUE_TPSProjectGameMode()
 	{
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
+
+	BotControllerClass = ABotController::StaticClass();
+}
+
+void AUE_TPSProjectGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	// Separates the matches in the combat telemetry
+	FCombatTelemetry::Record(CombatTelemetry::ERecordType::MatchStart, this);
+
+	if (GetNetMode() == NM_DedicatedServer && FParse::Param(FCommandLine::Get(), TEXT("Headless")))
+	{
+		StartHeadless();
+	}
+
+	int32 NumBots = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SoakBots="), NumBots))
+	{
+		SpawnBots(NumBots);
+	}
+}
+
+void AUE_TPSProjectGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AUE_TPSProjectGameMode::SpawnBots(int32 Count)
+{
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		ABotController* Bot = GetWorld()->SpawnActor<ABotController>(BotControllerClass, Params);
+		if (!Bot)
+		{
+			continue;
+		}
+
+		// Bots share the player starts, the offset keeps them from all piling on the same spot
+		AActor* Start = FindPlayerStart(Bot);
+		FTransform Transform = Start ? Start->GetActorTransform() : FTransform::Identity;
+		Transform.AddToTranslation(FVector(FMath::FRandRange(-400.0f, 400.0f), FMath::FRandRange(-400.0f, 400.0f), 0.0f));
+
+		APawn* Pawn = GetWorld()->SpawnActor<APawn>(GetDefaultPawnClassForController(Bot), Transform, Params);
+		if (!Pawn)
+		{
+			Bot->Destroy();
+			continue;
+		}
+		Bot->Possess(Pawn);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Spawned %d bots"), Count);
+}
+
+void AUE_TPSProjectGameMode::StartHeadless()
+{
+	FParse::Value(FCommandLine::Get(), TEXT("HeadlessTickRate="), HeadlessTickRate);
+	FParse::Value(FCommandLine::Get(), TEXT("HeadlessStatsInterval="), HeadlessStatsInterval);
+	HeadlessTickRate = FMath::Max(HeadlessTickRate, 1.0f);
+
+	// The net driver rate bounds the server loop, t.MaxFPS covers a server started without one
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		NetDriver->SetNetServerMaxTickRate(FMath::RoundToInt(HeadlessTickRate));
+	}
+	GEngine->SetMaxFPS(HeadlessTickRate);
+
+	if (HeadlessStatsInterval > 0.0f)
+	{
+		PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddWeakLambda(this, [this]()
+		{
+			GarbageCollectStart = FPlatformTime::Seconds();
+		});
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddWeakLambda(this, [this]()
+		{
+			MaxGarbageCollectPause = FMath::Max(MaxGarbageCollectPause, FPlatformTime::Seconds() - GarbageCollectStart);
+			NumGarbageCollects++;
+		});
+
+		LastReportFrame = GFrameCounter;
+		LastReportTime = FPlatformTime::Seconds();
+		GetWorldTimerManager().SetTimer(HeadlessStatsTimer, this, &AUE_TPSProjectGameMode::ReportHeadlessStats, HeadlessStatsInterval, true);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Headless server capped at %.0f Hz"), HeadlessTickRate);
+}
+
+void AUE_TPSProjectGameMode::ReportHeadlessStats()
+{
+	FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+	FCPUTime CPU = FPlatformTime::GetCPUTime();
+
+	int32 Pawns = 0;
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		Pawns++;
+	}
+
+	// Averaged over the interval, a drift shows as a slow rise between reports
+	double Now = FPlatformTime::Seconds();
+	uint64 Frames = FMath::Max<uint64>(GFrameCounter - LastReportFrame, 1);
+	double FrameTime = (Now - LastReportTime) / Frames;
+	LastReportFrame = GFrameCounter;
+	LastReportTime = Now;
+
+	// CPUTimePctRelative is relative to one core, which is what the instance packing is planned in
+	UE_LOG(LogTemp, Log, TEXT("Headless: %.1f MB resident, %.1f MB peak, %.1f%% of a core, %.2f ms frame, %d pawns, %d objects, %d GC (max %.1f ms)"),
+		Memory.UsedPhysical / (1024.0 * 1024.0), Memory.PeakUsedPhysical / (1024.0 * 1024.0),
+		CPU.CPUTimePctRelative, FrameTime * 1000.0, Pawns, GUObjectArray.GetObjectArrayNumMinusAvailable(),
+		NumGarbageCollects, MaxGarbageCollectPause * 1000.0);
+
+	NumGarbageCollects = 0;
+	MaxGarbageCollectPause = 0.0;
 }
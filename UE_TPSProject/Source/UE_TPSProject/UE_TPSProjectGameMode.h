@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "UE_TPSProjectGameMode.generated.h"
 
+class ABotController;
+
 UCLASS(minimalapi)
 class AUE_TPSProjectGameMode : public AGameModeBase
 {
@@ -13,6 +15,46 @@ class AUE_TPSProjectGameMode : public AGameModeBase
 
 public:
 	AUE_TPSProjectGameMode();
+
+	virtual void StartPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Controller of the bots spawned by SpawnBots */
+	UPROPERTY(EditAnywhere, Category = "Bots")
+	TSubclassOf<ABotController> BotControllerClass;
+
+	/** Spawn Count player characters driven by bots, at the player starts */
+	void SpawnBots(int32 Count);
+
+	/** Tick rate of a dedicated server started with -Headless, overridden by -HeadlessTickRate= */
+	UPROPERTY(EditAnywhere, Category = "Headless")
+	float HeadlessTickRate = 20.0f;
+
+	/** Seconds between two resource reports in headless mode, 0 disables them */
+	UPROPERTY(EditAnywhere, Category = "Headless")
+	float HeadlessStatsInterval = 10.0f;
+
+private:
+	FTimerHandle HeadlessStatsTimer;
+
+	FDelegateHandle PreGarbageCollectHandle;
+
+	FDelegateHandle PostGarbageCollectHandle;
+
+	/** Garbage collections since the last report, tracked for the soak tests */
+	double GarbageCollectStart = 0.0;
+	double MaxGarbageCollectPause = 0.0;
+	int32 NumGarbageCollects = 0;
+
+	/** Frame and time of the last report, the frame time is averaged between two reports */
+	uint64 LastReportFrame = 0;
+	double LastReportTime = 0.0;
+
+	/** Cap the tick rate so many match instances can share one machine */
+	void StartHeadless();
+
+	/** Log the memory, CPU, objects and garbage collections of this instance */
+	void ReportHeadlessStats();
 };
 
 
@@ -0,0 +1,16 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class UE_TPSProjectServerTarget : TargetRules
+{
+	public UE_TPSProjectServerTarget(TargetInfo Target) : base(Target)
+	{
+		// Dedicated server: UE_SERVER is set, the cosmetic code paths compile out (see WITH_COSMETICS)
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V4;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
+		ExtraModuleNames.Add("UE_TPSProject");
+	}
+}
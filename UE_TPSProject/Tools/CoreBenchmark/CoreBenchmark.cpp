@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Micro-benchmarks of the engine-free gameplay rules in GameplayCore.h, over millions of entities.
+// Used to tune the data layout and the vectorization of the rules without the editor:
+//   g++ -std=c++17 -O3 -march=native -o CoreBenchmark CoreBenchmark.cpp
+//   cl /std:c++17 /O2 /arch:AVX2 /EHsc CoreBenchmark.cpp
+// Usage: CoreBenchmark [entities] [frames]
+
+#include "../../Source/UE_TPSProject/GameplayCore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace GameplayCore;
+
+namespace
+{
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	/** Health of one entity the way the component stores it */
+	struct FHealthEntity
+	{
+		float Health;
+		float MaxHealth;
+		FRecoveryState Recovery;
+	};
+
+	template <typename BodyType>
+	void Run(const char* Name, size_t Entities, int Frames, BodyType Body) {
+		auto Start = std::chrono::steady_clock::now();
+		uint64_t Checksum = 0;
+		for (int Frame = 0; Frame < Frames; Frame++) {
+			Checksum += Body(Frame, Frame * DeltaTime);
+		}
+		auto End = std::chrono::steady_clock::now();
+
+		double Nanoseconds = std::chrono::duration<double, std::nano>(End - Start).count();
+		std::printf("%-32s %8.3f ms/frame %8.3f ns/entity  (checksum %llu)\n", Name,
+			Nanoseconds / Frames / 1.0e6, Nanoseconds / Frames / Entities, static_cast<unsigned long long>(Checksum));
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t Entities = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+	const int Frames = argc > 2 ? std::atoi(argv[2]) : 100;
+	std::printf("%zu entities, %d frames\n", Entities, Frames);
+
+	// A few percent of the entities take damage every frame, so both recovery paths are exercised
+	std::mt19937 Random(42);
+	std::vector<uint32_t> DamageEvents(Entities / 32);
+	for (uint32_t& Target : DamageEvents) {
+		Target = static_cast<uint32_t>(Random() % Entities);
+	}
+
+	const FRecoveryParams Params{true, 1.0f, 0.2f, 2.5f};
+
+	// Health, array of structs, one call per entity like the components
+	{
+		std::vector<FHealthEntity> Healths(Entities, FHealthEntity{100.0f, 100.0f, {}});
+		Run("Health recovery (AoS)", Entities, Frames, [&](int Frame, float Now) {
+			for (size_t Event = Frame % 8; Event < DamageEvents.size(); Event += 8) {
+				FHealthEntity& Entity = Healths[DamageEvents[Event]];
+				ApplyDamage(Entity.Health, Entity.MaxHealth, Entity.Recovery, 10.0f, Now);
+			}
+
+			uint64_t Recovered = 0;
+			for (FHealthEntity& Entity : Healths) {
+				Recovered += TickRecovery(Entity.Health, Entity.MaxHealth, Entity.Recovery, Params, DeltaTime, Now);
+			}
+			return Recovered;
+		});
+	}
+
+	// Health, struct of arrays, branchless batch
+	{
+		std::vector<float> Health(Entities, 100.0f);
+		std::vector<float> MaxHealth(Entities, 100.0f);
+		std::vector<float> ElapsedTime(Entities, 0.0f);
+		std::vector<float> LastDamageTime(Entities, 0.0f);
+		std::vector<uint8_t> IsDamaged(Entities, 0);
+
+		Run("Health recovery (SoA batch)", Entities, Frames, [&](int Frame, float Now) {
+			for (size_t Event = Frame % 8; Event < DamageEvents.size(); Event += 8) {
+				uint32_t Target = DamageEvents[Event];
+				Health[Target] = ClampHealth(Health[Target] - 10.0f, MaxHealth[Target]);
+				IsDamaged[Target] = 1;
+				LastDamageTime[Target] = Now;
+			}
+
+			TickRecoveryBatch(Health.data(), MaxHealth.data(), ElapsedTime.data(), LastDamageTime.data(), IsDamaged.data(),
+				Entities, Params, DeltaTime, Now);
+			return static_cast<uint64_t>(Health[Frame % Entities]);
+		});
+	}
+
+	// Patrol stepping on paths of 2 to 9 points
+	{
+		std::vector<FPatrolCursor> Cursors(Entities);
+		std::vector<int32_t> NumPoints(Entities);
+		for (size_t Index = 0; Index < Entities; Index++) {
+			NumPoints[Index] = 2 + static_cast<int32_t>(Index % 8);
+		}
+
+		Run("Patrol stepping", Entities, Frames, [&](int, float) {
+			uint64_t Sum = 0;
+			for (size_t Index = 0; Index < Entities; Index++) {
+				StepPatrol(Cursors[Index], NumPoints[Index]);
+				Sum += Cursors[Index].Index;
+			}
+			return Sum;
+		});
+	}
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Offline analyzer for the combat telemetry written with -CombatTelemetry=<file>.
+// Standalone on purpose, it only shares the file layout with the game:
+//   g++ -std=c++17 -O2 -o TelemetryAnalyzer TelemetryAnalyzer.cpp
+//   cl /std:c++17 /O2 /EHsc TelemetryAnalyzer.cpp
+// Usage: TelemetryAnalyzer <file>
+
+#include "../../Source/UE_TPSProject/CombatTelemetryFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace CombatTelemetry;
+
+namespace
+{
+	struct FHistogram
+	{
+		const char* Name;
+		const char* Unit;
+		float BucketSize;
+		std::vector<float> Samples;
+
+		void Print() const {
+			std::printf("\n%s (%zu samples)\n", Name, Samples.size());
+			if (Samples.empty()) {
+				return;
+			}
+
+			std::vector<float> Sorted = Samples;
+			std::sort(Sorted.begin(), Sorted.end());
+			std::printf("  min %.2f%s  median %.2f%s  p90 %.2f%s  max %.2f%s\n",
+				Sorted.front(), Unit, Sorted[Sorted.size() / 2], Unit,
+				Sorted[Sorted.size() * 9 / 10], Unit, Sorted.back(), Unit);
+
+			std::vector<size_t> Buckets(static_cast<size_t>(Sorted.back() / BucketSize) + 1, 0);
+			for (float Sample : Sorted) {
+				Buckets[static_cast<size_t>(Sample / BucketSize)]++;
+			}
+
+			const size_t Largest = *std::max_element(Buckets.begin(), Buckets.end());
+			for (size_t Bucket = 0; Bucket < Buckets.size(); Bucket++) {
+				const int Width = static_cast<int>(Buckets[Bucket] * 50 / Largest);
+				std::printf("  %7.2f-%-7.2f %6zu |%.*s\n", Bucket * BucketSize, (Bucket + 1) * BucketSize,
+					Buckets[Bucket], Width, "##################################################");
+			}
+		}
+	};
+
+	struct FShooterStats
+	{
+		uint64_t Shots = 0;
+		uint64_t Hits = 0;
+	};
+
+	/** Read the committed records in write order. Slots overwritten while the file was copied are dropped */
+	bool ReadRecords(const char* Path, std::vector<FRecord>& Records) {
+		std::ifstream File(Path, std::ios::binary);
+		FHeader Header;
+		if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header))) {
+			std::fprintf(stderr, "Cannot read %s\n", Path);
+			return false;
+		}
+
+		if (Header.Magic != Magic || Header.Version != Version || Header.RecordSize != sizeof(FRecord)) {
+			std::fprintf(stderr, "%s is not a supported combat telemetry file\n", Path);
+			return false;
+		}
+
+		std::vector<FRecord> Slots(Header.Capacity);
+		File.read(reinterpret_cast<char*>(Slots.data()), Slots.size() * sizeof(FRecord));
+		Slots.resize(File.gcount() / sizeof(FRecord));
+
+		for (size_t Slot = 0; Slot < Slots.size(); Slot++) {
+			const int64_t Commit = Slots[Slot].Commit;
+			if (Commit > 0 && static_cast<uint64_t>(Commit - 1) % Header.Capacity == Slot) {
+				Records.push_back(Slots[Slot]);
+			}
+		}
+
+		std::sort(Records.begin(), Records.end(), [](const FRecord& A, const FRecord& B) { return A.Commit < B.Commit; });
+
+		if (Header.WriteIndex > static_cast<int64_t>(Header.Capacity)) {
+			std::printf("Ring buffer wrapped, the oldest %lld records are lost\n",
+				static_cast<long long>(Header.WriteIndex - Header.Capacity));
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "Usage: %s <telemetry file>\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<FRecord> Records;
+	if (!ReadRecords(argv[1], Records)) {
+		return 1;
+	}
+
+	FHistogram TimeToKill{"Time to kill, first damage to death", "s", 0.5f, {}};
+	FHistogram Accuracy{"Accuracy per shooter and match", "%", 5.0f, {}};
+	FHistogram AlertPropagation{"Alert propagation, delay after the first alert of the match", "s", 0.25f, {}};
+
+	std::unordered_map<uint32_t, FShooterStats> Shooters;
+	std::unordered_map<uint32_t, float> FirstDamage;
+	std::unordered_map<uint32_t, bool> Alerted;
+	float FirstAlert = -1.0f;
+	uint64_t Matches = 0;
+	uint64_t TotalShots = 0;
+	uint64_t TotalHits = 0;
+
+	// Per-match state is flushed in the histograms when the next match starts
+	auto EndMatch = [&]() {
+		for (const auto& Shooter : Shooters) {
+			if (Shooter.second.Shots > 0) {
+				Accuracy.Samples.push_back(100.0f * Shooter.second.Hits / Shooter.second.Shots);
+			}
+			TotalShots += Shooter.second.Shots;
+			TotalHits += Shooter.second.Hits;
+		}
+		Shooters.clear();
+		FirstDamage.clear();
+		Alerted.clear();
+		FirstAlert = -1.0f;
+	};
+
+	for (const FRecord& Record : Records) {
+		switch (static_cast<ERecordType>(Record.Type)) {
+		case ERecordType::MatchStart:
+			EndMatch();
+			Matches++;
+			break;
+		case ERecordType::Shot:
+			Shooters[Record.Source].Shots++;
+			break;
+		case ERecordType::Hit:
+			Shooters[Record.Source].Hits++;
+			break;
+		case ERecordType::Damage:
+			FirstDamage.emplace(Record.Target, Record.Time);
+			break;
+		case ERecordType::Alert:
+			// Alerts are repeated while the player stays in sight, only the first one of each enemy counts
+			if (Alerted.emplace(Record.Source, true).second) {
+				if (FirstAlert < 0.0f) {
+					FirstAlert = Record.Time;
+				}
+				AlertPropagation.Samples.push_back(Record.Time - FirstAlert);
+			}
+			break;
+		case ERecordType::Death: {
+			auto Damaged = FirstDamage.find(Record.Target);
+			if (Damaged != FirstDamage.end()) {
+				TimeToKill.Samples.push_back(Record.Time - Damaged->second);
+				FirstDamage.erase(Damaged);
+			}
+			break;
+		}
+		}
+	}
+	EndMatch();
+
+	std::printf("%zu records, %llu matches\n", Records.size(), static_cast<unsigned long long>(Matches));
+	std::printf("%llu shots, %llu hits, overall accuracy %.1f%%\n",
+		static_cast<unsigned long long>(TotalShots), static_cast<unsigned long long>(TotalHits),
+		TotalShots ? 100.0 * TotalHits / TotalShots : 0.0);
+
+	TimeToKill.Print();
+	Accuracy.Print();
+	AlertPropagation.Print();
+	return 0;
+}